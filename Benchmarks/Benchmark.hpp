@@ -0,0 +1,79 @@
+#pragma once
+
+#include "../SoundGenerators.hpp"
+#include <stdio.h>
+
+//
+// Micro-benchmarks of the generators. They are not a part of the main build, see Main.cpp.
+//
+
+const uint32_t BENCHMARK_SAMPLE_RATE = 48000;
+const uint32_t BENCHMARK_BLOCK_FRAMES = 256; // Same as blocks of CSoundSession.
+
+// Results are written here, so the compiler can't drop the measured code.
+inline volatile float g_benchmark_sink;
+
+inline double GetSeconds()
+{
+	static double frequency = 0.0;
+
+	if (frequency == 0.0)
+	{
+		LARGE_INTEGER value;
+		QueryPerformanceFrequency(&value);
+		frequency = double(value.QuadPart);
+	}
+
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return counter.QuadPart / frequency;
+}
+
+//
+// Call the function over and over for a while, and return the best time per frame in nanoseconds.
+// The function renders the given number of frames per call. The best of several rounds hides interrupts and migrations.
+//
+template <typename F>
+double MeasureNsPerFrame(size_t frames_per_call, F&& func)
+{
+	const int ROUNDS = 5;
+	const double ROUND_SECONDS = 0.1;
+
+	// Warm up, and find how many calls take about a round.
+	size_t calls = 1;
+	for (double start = GetSeconds(); GetSeconds() - start < ROUND_SECONDS / 4; calls *= 2)
+	{
+		for (size_t i = 0; i < calls; i++) { func(); }
+	}
+
+	double best = 1e300;
+
+	for (int round = 0; round < ROUNDS; round++)
+	{
+		double start = GetSeconds();
+		for (size_t i = 0; i < calls; i++) { func(); }
+		best = std::min(best, (GetSeconds() - start) / (double(calls) * frames_per_call));
+	}
+
+	return best * 1e9;
+}
+
+inline void PrintResult(const char* name, double ns_per_frame, double base_ns_per_frame = 0.0)
+{
+	if (base_ns_per_frame > 0.0)
+	{
+		printf("  %-40s %8.2f ns/frame  %6.2fx\n", name, ns_per_frame, base_ns_per_frame / ns_per_frame);
+	}
+	else
+	{
+		printf("  %-40s %8.2f ns/frame\n", name, ns_per_frame);
+	}
+}
+
+// Benchmarks. Each one prints its own results.
+void BenchmarkSine();
+void BenchmarkPinkNoise();
+void BenchmarkBrownNoise();
+void BenchmarkFixedPoint();
+void BenchmarkStreaming();
+void BenchmarkDecorrelatedNoise();
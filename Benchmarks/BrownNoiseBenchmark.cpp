@@ -0,0 +1,68 @@
+//
+// Brown noise: the integrator with division, fmod() and branchy mirroring per frame (before block generators), and
+// the leaky integrator with a precomputed multiplier and branch-free mirroring on blocks.
+//
+
+#include "Benchmark.hpp"
+
+// The generator before block generators: LCG white noise, SoX integrator with a division and fmod() for each frame.
+static void GenerateBrownNoisePerFrame(float* out, size_t count, uint64_t& lcg_state, double& state, double amplitude)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		lcg_state = lcg_state * 6364136223846793005ULL + 1; // LCG from Musl.
+		double value = (double((lcg_state >> 32) & 0x7FFFFFFF) / double(0x7FFFFFFFU)) * 2.0 - 1.0;
+
+		state += value * (1.0 / 16);
+		state /= 1.02;
+		state = fmod(state, 4);
+		value = state;
+
+		if (value < -1.0 || 1.0 < value)
+		{
+			double sign = (value < 0.0) ? -1.0 : 1.0;
+			value = fabs(value);
+			value = ((value <= 3.0) ? (2.0 - value) : (value - 4.0)) * sign;
+		}
+
+		out[i] = float(value * amplitude);
+	}
+}
+
+void BenchmarkBrownNoise()
+{
+	const float AMPLITUDE = 0.01f;
+	const uint32_t SEED = 0x5EED1234;
+
+	alignas(32) float block[BENCHMARK_BLOCK_FRAMES];
+	BrownNoiseFilter filter = MakeBrownNoiseFilter(BENCHMARK_SAMPLE_RATE);
+	uint64_t lcg_state = 1;
+	double state = 0.0;
+	uint32_t counter = 0;
+
+	double per_frame = MeasureNsPerFrame(BENCHMARK_BLOCK_FRAMES, [&]
+	{
+		GenerateBrownNoisePerFrame(block, BENCHMARK_BLOCK_FRAMES, lcg_state, state, AMPLITUDE);
+		g_benchmark_sink = block[0];
+	});
+
+	state = 0.0;
+
+	double blocks = MeasureNsPerFrame(BENCHMARK_BLOCK_FRAMES, [&]
+	{
+		GenerateUniform(block, BENCHMARK_BLOCK_FRAMES, counter, SEED, 1.0f);
+		FilterBrownNoise(block, BENCHMARK_BLOCK_FRAMES, state, filter, AMPLITUDE);
+		counter += BENCHMARK_BLOCK_FRAMES;
+		g_benchmark_sink = block[0];
+	});
+
+	double filter_only = MeasureNsPerFrame(BENCHMARK_BLOCK_FRAMES, [&]
+	{
+		FilterBrownNoise(block, BENCHMARK_BLOCK_FRAMES, state, filter, 1.0f);
+		g_benchmark_sink = block[0];
+	});
+
+	PrintResult("Per frame (division, fmod)", per_frame);
+	PrintResult("Blocks (leaky integrator)", blocks, per_frame);
+	PrintResult("  of that, the integrator", filter_only);
+}
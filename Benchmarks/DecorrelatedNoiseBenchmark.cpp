@@ -0,0 +1,73 @@
+//
+// Decorrelated pink noise on multichannel outputs against the same mono noise written to all channels. Lane kernels
+// generate a vector of channels at once, so the cost depends on how many passes a frame takes, and how the lanes are
+// written to the frames. Frames are packed floats, as shared mode streams have.
+//
+
+#include "Benchmark.hpp"
+
+void BenchmarkDecorrelatedNoise()
+{
+	const float AMPLITUDE = 0.001f;
+	const uint32_t SEED = 0x5EED1234;
+	const size_t CHANNELS[] = { 2, 6, 8 };
+
+	GeneratorKernels kernels = SelectGeneratorKernels(DetectCpuFeatures());
+	PinkNoiseFilter filter = MakePinkNoiseFilter(BENCHMARK_SAMPLE_RATE);
+
+	// The baseline lane kernels and the ones sessions select on this CPU.
+	const NoiseLaneKernels LANES[] = { MakeNoiseLaneKernels<>(), kernels.lanes };
+	size_t lanes_count = (kernels.lanes.width == LANES[0].width) ? 1 : 2;
+	char name[64];
+
+	alignas(32) float block[BENCHMARK_BLOCK_FRAMES];
+	alignas(32) float lanes[BENCHMARK_BLOCK_FRAMES * NOISE_LANE_CHANNELS];
+	alignas(32) static float frames[BENCHMARK_BLOCK_FRAMES * NOISE_LANE_CHANNELS];
+
+	for (size_t channels : CHANNELS)
+	{
+		BlockParams params = { {}, 1.0f, channels, channels * sizeof(float) };
+		uint8_t* out = reinterpret_cast<uint8_t*>(frames);
+		printf(" %zu channels:\n", channels);
+
+		// Same as the session renders pink noise on SIMD targets when the channels are not decorrelated.
+		BlockFunc fan_out = kernels.select_chains(channels, params.frame_size, false).steady;
+		float mono_state[9] = {};
+		uint32_t counter = 0;
+
+		double base = MeasureNsPerFrame(BENCHMARK_BLOCK_FRAMES, [&]
+		{
+			kernels.generate_uniform(block, BENCHMARK_BLOCK_FRAMES, counter, SEED, 1.0f);
+			FilterPinkNoiseFloat(block, BENCHMARK_BLOCK_FRAMES, mono_state, filter, AMPLITUDE);
+			fan_out(out, block, BENCHMARK_BLOCK_FRAMES, params);
+			counter += BENCHMARK_BLOCK_FRAMES;
+			g_benchmark_sink = frames[0];
+		});
+
+		PrintResult("Mono, written to all channels", base);
+
+		for (size_t i = 0; i < lanes_count; i++)
+		{
+			const NoiseLaneKernels& lane_kernels = LANES[i];
+			NoiseLanesState state = {};
+			counter = 0;
+
+			double time = MeasureNsPerFrame(BENCHMARK_BLOCK_FRAMES, [&]
+			{
+				for (size_t first_channel = 0; first_channel < channels; first_channel += lane_kernels.width)
+				{
+					lane_kernels.generate_uniform(lanes, BENCHMARK_BLOCK_FRAMES, counter, SEED, first_channel, 1.0f);
+					lane_kernels.filter_pink(lanes, BENCHMARK_BLOCK_FRAMES, state, first_channel, filter, AMPLITUDE);
+					lane_kernels.fan_out(out, lanes, BENCHMARK_BLOCK_FRAMES, first_channel, params);
+				}
+
+				counter += BENCHMARK_BLOCK_FRAMES;
+				g_benchmark_sink = frames[0];
+			});
+
+			// A speedup below 1 is the cost of decorrelation.
+			sprintf(name, "Decorrelated, %zu lanes", lane_kernels.width);
+			PrintResult(name, time, base);
+		}
+	}
+}
@@ -0,0 +1,94 @@
+//
+// Fixed-point (the "FixedPoint" switch) against floating-point generators, from the generator to 16-bit stereo frames,
+// the way CSoundSession renders steady blocks. Fixed-point is meant for SoundKeeper32 on old CPUs, so the numbers that
+// matter come from the Win32 build of this project.
+//
+
+#include "Benchmark.hpp"
+
+void BenchmarkFixedPoint()
+{
+	const float AMPLITUDE = 0.01f;
+	const uint32_t SEED = 0x5EED1234;
+	const size_t CHANNELS = 2;
+	const size_t FRAME_SIZE = CHANNELS * sizeof(int16_t);
+
+	alignas(32) float block[BENCHMARK_BLOCK_FRAMES];
+	alignas(32) int32_t samples[BENCHMARK_BLOCK_FRAMES];
+	alignas(32) static uint8_t frames[BENCHMARK_BLOCK_FRAMES * FRAME_SIZE];
+
+	GeneratorKernels kernels = SelectGeneratorKernels(DetectCpuFeatures());
+	BlockChains chains = kernels.select_chains(CHANNELS, FRAME_SIZE, true);
+	BlockParams float_params = { {}, 1.0f, CHANNELS, FRAME_SIZE };
+	BlockParams fixed_params = { {}, AMPLITUDE / Q30_ONE, CHANNELS, FRAME_SIZE };
+
+	BrownNoiseFilter brown_filter = MakeBrownNoiseFilter(BENCHMARK_SAMPLE_RATE);
+	uint32_t pink_rows = GetPinkNoiseRows(BENCHMARK_SAMPLE_RATE);
+	uint32_t increment = SinePhaseIncrement(1.0, BENCHMARK_SAMPLE_RATE);
+	uint32_t phase = 0;
+	uint32_t counter = 0;
+	double brown_state = 0.0;
+	int32_t brown_level = 0;
+	int32_t voss_state[PINK_NOISE_MAX_ROWS + 1] = {};
+
+	auto store_float = [&]
+	{
+		chains.steady(frames, block, BENCHMARK_BLOCK_FRAMES, float_params);
+		counter += BENCHMARK_BLOCK_FRAMES;
+		phase += increment * BENCHMARK_BLOCK_FRAMES;
+		g_benchmark_sink = frames[0];
+	};
+
+	auto store_fixed = [&]
+	{
+		chains.fixed(frames, samples, BENCHMARK_BLOCK_FRAMES, fixed_params);
+		counter += BENCHMARK_BLOCK_FRAMES;
+		phase += increment * BENCHMARK_BLOCK_FRAMES;
+		g_benchmark_sink = frames[0];
+	};
+
+	double sine_float = MeasureNsPerFrame(BENCHMARK_BLOCK_FRAMES, [&]
+	{
+		kernels.generate_sine(block, BENCHMARK_BLOCK_FRAMES, phase, increment, AMPLITUDE);
+		store_float();
+	});
+
+	double sine_fixed = MeasureNsPerFrame(BENCHMARK_BLOCK_FRAMES, [&]
+	{
+		GenerateSineQ30(samples, BENCHMARK_BLOCK_FRAMES, phase, increment);
+		store_fixed();
+	});
+
+	double brown_float = MeasureNsPerFrame(BENCHMARK_BLOCK_FRAMES, [&]
+	{
+		kernels.generate_uniform(block, BENCHMARK_BLOCK_FRAMES, counter, SEED, 1.0f);
+		FilterBrownNoise(block, BENCHMARK_BLOCK_FRAMES, brown_state, brown_filter, AMPLITUDE);
+		store_float();
+	});
+
+	double brown_fixed = MeasureNsPerFrame(BENCHMARK_BLOCK_FRAMES, [&]
+	{
+		GenerateUniformQ30(samples, BENCHMARK_BLOCK_FRAMES, counter, SEED);
+		FilterBrownNoiseQ30(samples, BENCHMARK_BLOCK_FRAMES, brown_level, brown_filter);
+		store_fixed();
+	});
+
+	double pink_float = MeasureNsPerFrame(BENCHMARK_BLOCK_FRAMES, [&]
+	{
+		GeneratePinkNoiseVoss(block, BENCHMARK_BLOCK_FRAMES, counter, SEED, voss_state, pink_rows, AMPLITUDE);
+		store_float();
+	});
+
+	double pink_fixed = MeasureNsPerFrame(BENCHMARK_BLOCK_FRAMES, [&]
+	{
+		GeneratePinkNoiseVossQ30(samples, BENCHMARK_BLOCK_FRAMES, counter, SEED, voss_state, pink_rows);
+		store_fixed();
+	});
+
+	PrintResult("Sine (float)", sine_float);
+	PrintResult("Sine (fixed)", sine_fixed, sine_float);
+	PrintResult("Brown (float)", brown_float);
+	PrintResult("Brown (fixed)", brown_fixed, brown_float);
+	PrintResult("Pink Voss (float)", pink_float);
+	PrintResult("Pink Voss (fixed)", pink_fixed, pink_float);
+}
@@ -0,0 +1,56 @@
+//
+// Benchmarks of the sound generators. Run without arguments to run all of them, or pass the names of the ones to run.
+// Build it with Benchmarks.vcxproj, it's not a part of the solution, so the default build doesn't include it.
+//
+
+#include "Benchmark.hpp"
+
+const struct
+{
+	const char* name;
+	void (*run)();
+}
+BENCHMARKS[] =
+{
+	{ "sine", BenchmarkSine },
+	{ "pink", BenchmarkPinkNoise },
+	{ "brown", BenchmarkBrownNoise },
+	{ "fixed", BenchmarkFixedPoint },
+	{ "streaming", BenchmarkStreaming },
+	{ "decorrelated", BenchmarkDecorrelatedNoise },
+};
+
+int main(int argc, char** argv)
+{
+	GeneratorKernels kernels = SelectGeneratorKernels(DetectCpuFeatures());
+	printf("Kernels: %s. Sample rate: %u Hz. Block: %u frames.\n\n", kernels.name, BENCHMARK_SAMPLE_RATE, BENCHMARK_BLOCK_FRAMES);
+
+	int ran_count = 0;
+
+	for (const auto& benchmark : BENCHMARKS)
+	{
+		bool is_selected = (argc < 2);
+		for (int i = 1; i < argc; i++)
+		{
+			if (StringEquals<AsciiToLower>(argv[i], benchmark.name)) { is_selected = true; }
+		}
+
+		if (is_selected)
+		{
+			printf("[%s]\n", benchmark.name);
+			benchmark.run();
+			printf("\n");
+			ran_count++;
+		}
+	}
+
+	if (!ran_count)
+	{
+		printf("Unknown benchmark. Available:");
+		for (const auto& benchmark : BENCHMARKS) { printf(" %s", benchmark.name); }
+		printf("\n");
+		return 1;
+	}
+
+	return 0;
+}
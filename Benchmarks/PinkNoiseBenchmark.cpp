@@ -0,0 +1,191 @@
+//
+// Pink noise engines: Paul Kellet's filter per frame (before block generators), the same filter in double and single
+// precision on blocks, and Voss-McCartney. Besides the speed, it compares their spectra: the slope should be -3 dB per
+// octave, and the deviation from it shows the ripple of each engine.
+//
+
+#include "Benchmark.hpp"
+
+// The generator before block generators: LCG white noise and Kellet's filter in double for each frame.
+static void GeneratePinkNoisePerFrame(float* out, size_t count, uint64_t& lcg_state, double* state, double amplitude)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		lcg_state = lcg_state * 6364136223846793005ULL + 1; // LCG from Musl.
+		double white = (double((lcg_state >> 32) & 0x7FFFFFFF) / double(0x7FFFFFFFU)) * 2.0 - 1.0;
+
+		state[0] = 0.99886 * state[0] + white * 0.0555179;
+		state[1] = 0.99332 * state[1] + white * 0.0750759;
+		state[2] = 0.96900 * state[2] + white * 0.1538520;
+		state[3] = 0.86650 * state[3] + white * 0.3104856;
+		state[4] = 0.55000 * state[4] + white * 0.5329522;
+		state[5] = -0.7616 * state[5] - white * 0.0168980;
+		double value = state[0] + state[1] + state[2] + state[3] + state[4] + state[5] + state[6] + white * 0.5362;
+		state[6] = white * 0.115926;
+
+		out[i] = float(value * 0.11 * amplitude);
+	}
+}
+
+enum class PinkEngine { PerFrame, KelletDouble, KelletFloat, Voss };
+
+// One engine with its state, so the speed and the spectrum are measured on the same code.
+struct PinkNoise
+{
+	PinkEngine engine;
+	PinkNoiseFilter filter = MakePinkNoiseFilter(BENCHMARK_SAMPLE_RATE);
+	uint32_t rows = GetPinkNoiseRows(BENCHMARK_SAMPLE_RATE);
+	uint32_t counter = 0;
+	uint64_t lcg_state = 1;
+	double double_state[8] = {};
+	float float_state[9] = {};
+	int32_t voss_state[PINK_NOISE_MAX_ROWS + 1] = {};
+
+	PinkNoise(PinkEngine engine) : engine(engine) {}
+
+	void Generate(float* out, size_t count, float amplitude)
+	{
+		const uint32_t SEED = 0x5EED1234;
+
+		switch (engine)
+		{
+		case PinkEngine::PerFrame:
+			GeneratePinkNoisePerFrame(out, count, lcg_state, double_state, amplitude);
+			break;
+		case PinkEngine::KelletDouble:
+			GenerateUniform(out, count, counter, SEED, 1.0f);
+			FilterPinkNoise(out, count, double_state, filter, amplitude);
+			break;
+		case PinkEngine::KelletFloat:
+			GenerateUniform(out, count, counter, SEED, 1.0f);
+			FilterPinkNoiseFloat(out, count, float_state, filter, amplitude);
+			break;
+		case PinkEngine::Voss:
+			GeneratePinkNoiseVoss(out, count, counter, SEED, voss_state, rows, amplitude);
+			break;
+		}
+
+		counter += uint32_t(count);
+	}
+};
+
+struct SpectrumSlope
+{
+	double db_per_octave;
+	double max_deviation_db;
+};
+
+//
+// Welch's method: the average power spectrum of Hann windowed segments. Powers are summed in 1/3 octave bands from
+// 50 Hz to 16 kHz, and a line is fitted to their densities in dB against octaves.
+static SpectrumSlope MeasureSpectrumSlope(PinkNoise& noise)
+{
+	const size_t FFT_SIZE = 4096;
+	const size_t SEGMENTS = 4096; // 2^24 frames, so the low bands are averaged enough.
+	const size_t BANDS = 25; // 1/3 octaves from 50 Hz.
+
+	alignas(16) static float re[FFT_SIZE], im[FFT_SIZE], twiddles[FFT_SIZE * 2];
+	static double power[FFT_SIZE / 2];
+	InitFftTwiddles(twiddles, FFT_SIZE);
+	memset(power, 0, sizeof(power));
+
+	unsigned long stages = 0;
+	_BitScanForward(&stages, uint32_t(FFT_SIZE));
+
+	for (size_t segment = 0; segment < SEGMENTS; segment++)
+	{
+		noise.Generate(re, FFT_SIZE, 1.0f);
+
+		for (size_t i = 0; i < FFT_SIZE; i++)
+		{
+			re[i] *= float(0.5 - 0.5 * cos(2 * M_PI * i / FFT_SIZE));
+			im[i] = 0.0f;
+		}
+
+		FftForward(re, im, FFT_SIZE, twiddles);
+
+		// The spectrum is in bit-reversed order.
+		for (size_t k = 1; k < FFT_SIZE / 2; k++)
+		{
+			size_t j = 0;
+			for (unsigned long b = 0; b < stages; b++) { j |= ((k >> b) & 1) << (stages - 1 - b); }
+			power[k] += double(re[j]) * re[j] + double(im[j]) * im[j];
+		}
+	}
+
+	double octaves[BANDS], levels[BANDS];
+	double bin_hz = double(BENCHMARK_SAMPLE_RATE) / FFT_SIZE;
+
+	for (size_t band = 0; band < BANDS; band++)
+	{
+		double low = 50.0 * pow(2.0, band / 3.0), high = low * pow(2.0, 1.0 / 3.0);
+		double sum = 0.0;
+		size_t bins = 0;
+
+		for (size_t k = size_t(ceil(low / bin_hz)); k * bin_hz < high; k++, bins++) { sum += power[k]; }
+
+		octaves[band] = log2(sqrt(low * high) / 1000.0);
+		levels[band] = 10 * log10(sum / bins);
+	}
+
+	// Least squares line.
+	double mean_x = 0.0, mean_y = 0.0;
+	for (size_t i = 0; i < BANDS; i++) { mean_x += octaves[i] / BANDS; mean_y += levels[i] / BANDS; }
+
+	double sxx = 0.0, sxy = 0.0;
+	for (size_t i = 0; i < BANDS; i++)
+	{
+		sxx += (octaves[i] - mean_x) * (octaves[i] - mean_x);
+		sxy += (octaves[i] - mean_x) * (levels[i] - mean_y);
+	}
+
+	SpectrumSlope result = { sxy / sxx, 0.0 };
+
+	for (size_t i = 0; i < BANDS; i++)
+	{
+		double fitted = mean_y + result.db_per_octave * (octaves[i] - mean_x);
+		result.max_deviation_db = std::max(result.max_deviation_db, fabs(levels[i] - fitted));
+	}
+
+	return result;
+}
+
+void BenchmarkPinkNoise()
+{
+	const float AMPLITUDE = 0.001f;
+
+	const struct { const char* name; PinkEngine engine; } ENGINES[] =
+	{
+		{ "Kellet per frame", PinkEngine::PerFrame },
+		{ "Kellet (double)", PinkEngine::KelletDouble },
+		{ "Kellet (float)", PinkEngine::KelletFloat },
+		{ "Voss-McCartney", PinkEngine::Voss },
+	};
+
+	alignas(32) float block[BENCHMARK_BLOCK_FRAMES];
+	double base = 0.0;
+
+	printf(" Speed:\n");
+
+	for (const auto& engine : ENGINES)
+	{
+		PinkNoise noise(engine.engine);
+		double time = MeasureNsPerFrame(BENCHMARK_BLOCK_FRAMES, [&]
+		{
+			noise.Generate(block, BENCHMARK_BLOCK_FRAMES, AMPLITUDE);
+			g_benchmark_sink = block[0];
+		});
+
+		PrintResult(engine.name, time, base);
+		if (base == 0.0) { base = time; }
+	}
+
+	printf(" Spectrum, 50 Hz to 16 kHz (pink is -3.01 dB/octave):\n");
+
+	for (const auto& engine : ENGINES)
+	{
+		PinkNoise noise(engine.engine);
+		SpectrumSlope slope = MeasureSpectrumSlope(noise);
+		printf("  %-40s %8.2f dB/octave, max deviation %.2f dB\n", engine.name, slope.db_per_octave, slope.max_deviation_db);
+	}
+}
@@ -0,0 +1,66 @@
+//
+// Sine generators: libm sin() per frame (before the vectorized generator), the scalar table (the "Scalar" switch),
+// and the vectorized kernels. Mono blocks only, writing frames to the channels is the same for all of them.
+//
+
+#include "Benchmark.hpp"
+
+// The generator before the vectorized one: a double phase in radians and sin() for each frame.
+static void GenerateSineLibm(float* out, size_t count, double& theta, double theta_increment, double amplitude)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		out[i] = float(sin(theta) * amplitude);
+		theta += theta_increment;
+	}
+}
+
+void BenchmarkSine()
+{
+	const double FREQUENCY = 1.0;
+	const float AMPLITUDE = 0.01f;
+
+	alignas(32) float block[BENCHMARK_BLOCK_FRAMES];
+	GeneratorKernels kernels = SelectGeneratorKernels(DetectCpuFeatures());
+	uint32_t increment = SinePhaseIncrement(FREQUENCY, BENCHMARK_SAMPLE_RATE);
+	uint32_t phase = 0;
+	double theta = 0.0;
+	double theta_increment = FREQUENCY * (M_PI * 2) / BENCHMARK_SAMPLE_RATE;
+
+	InitSineTable();
+
+	double libm = MeasureNsPerFrame(BENCHMARK_BLOCK_FRAMES, [&]
+	{
+		GenerateSineLibm(block, BENCHMARK_BLOCK_FRAMES, theta, theta_increment, AMPLITUDE);
+		g_benchmark_sink = block[0];
+	});
+
+	double table = MeasureNsPerFrame(BENCHMARK_BLOCK_FRAMES, [&]
+	{
+		GenerateSineFromTable(block, BENCHMARK_BLOCK_FRAMES, phase, increment, AMPLITUDE);
+		phase += increment * BENCHMARK_BLOCK_FRAMES;
+		g_benchmark_sink = block[0];
+	});
+
+	double baseline = MeasureNsPerFrame(BENCHMARK_BLOCK_FRAMES, [&]
+	{
+		GenerateSine<>(block, BENCHMARK_BLOCK_FRAMES, phase, increment, AMPLITUDE);
+		phase += increment * BENCHMARK_BLOCK_FRAMES;
+		g_benchmark_sink = block[0];
+	});
+
+	double selected = MeasureNsPerFrame(BENCHMARK_BLOCK_FRAMES, [&]
+	{
+		kernels.generate_sine(block, BENCHMARK_BLOCK_FRAMES, phase, increment, AMPLITUDE);
+		phase += increment * BENCHMARK_BLOCK_FRAMES;
+		g_benchmark_sink = block[0];
+	});
+
+	char name[64];
+	sprintf(name, "Vectorized (%s)", kernels.name);
+
+	PrintResult("libm sin() per frame", libm);
+	PrintResult("Table (Scalar switch)", table, libm);
+	PrintResult("Vectorized (baseline)", baseline, libm);
+	PrintResult(name, selected, libm);
+}
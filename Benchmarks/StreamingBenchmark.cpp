@@ -0,0 +1,131 @@
+//
+// Streaming stores for large buffers. A foreground workload chases pointers through a working set that fits the
+// cache, and between its runs a keep-alive buffer is rendered: 1 second of 192 kHz 8-channel float, about 6 MB.
+// The time of the first chase after each buffer shows how much of the working set the buffer has evicted.
+// Runs are interleaved on one thread, so the result doesn't depend on the number of cores and their shared caches.
+//
+
+#include "Benchmark.hpp"
+
+// A random cyclic permutation of cache lines, so the hardware prefetcher can't predict the next one.
+struct PointerChase
+{
+	static const size_t LINE_SIZE = 64;
+
+	uint8_t* memory = nullptr;
+	size_t lines = 0;
+
+	void Init(size_t size)
+	{
+		lines = size / LINE_SIZE;
+		memory = new uint8_t[size];
+
+		uint32_t* order = new uint32_t[lines];
+		for (size_t i = 0; i < lines; i++) { order[i] = uint32_t(i); }
+		for (size_t i = lines - 1; i > 0; i--) { std::swap(order[i], order[HashCounter(uint32_t(i)) % (i + 1)]); }
+
+		for (size_t i = 0; i < lines; i++)
+		{
+			*reinterpret_cast<uint8_t**>(memory + order[i] * LINE_SIZE) = memory + order[(i + 1) % lines] * LINE_SIZE;
+		}
+
+		delete[] order;
+	}
+
+	~PointerChase()
+	{
+		delete[] memory;
+	}
+
+	// Visit all lines once, and return the time per line in nanoseconds.
+	double Run()
+	{
+		double start = GetSeconds();
+		uint8_t* p = memory;
+		for (size_t i = 0; i < lines; i++) { p = *reinterpret_cast<uint8_t**>(p); }
+		double time = GetSeconds() - start;
+		g_benchmark_sink = float(uintptr_t(p) & 1);
+		return time * 1e9 / lines;
+	}
+};
+
+enum class StoreMode { None, Regular, Streaming };
+
+void BenchmarkStreaming()
+{
+	const uint32_t SAMPLE_RATE = 192000;
+	const size_t CHANNELS = 8;
+	const size_t FRAME_SIZE = CHANNELS * sizeof(float);
+	const size_t BUFFER_FRAMES = SAMPLE_RATE; // 1000 ms shared mode buffer.
+	const size_t WORKING_SETS[] = { 256 * 1024, 1024 * 1024, 4 * 1024 * 1024 };
+	const int ROUNDS = 20;
+
+	GeneratorKernels kernels = SelectGeneratorKernels(DetectCpuFeatures());
+	BlockChains regular_chains = kernels.select_chains(CHANNELS, FRAME_SIZE, false);
+	BlockChains streaming_chains = SelectStreamingBlockChains(CHANNELS, FRAME_SIZE, false);
+	BlockParams params = { {}, 1.0f, CHANNELS, FRAME_SIZE };
+
+	if (!streaming_chains.steady)
+	{
+		printf("  Streaming stores are not supported on this platform.\n");
+		return;
+	}
+
+	uint8_t* buffer = new uint8_t[BUFFER_FRAMES * FRAME_SIZE];
+	defer [&]{ delete[] buffer; };
+
+	alignas(32) float block[BENCHMARK_BLOCK_FRAMES];
+	uint32_t counter = 0;
+
+	// Same as a steady segment of a noise stream: mono blocks written to all channels.
+	auto render = [&](const BlockChains& chains)
+	{
+		for (size_t done = 0; done < BUFFER_FRAMES; done += BENCHMARK_BLOCK_FRAMES)
+		{
+			size_t frames = std::min<size_t>(BUFFER_FRAMES - done, BENCHMARK_BLOCK_FRAMES);
+			kernels.generate_uniform(block, frames, counter, 1, 0.01f);
+			chains.steady(buffer + done * FRAME_SIZE, block, frames, params);
+			counter += uint32_t(frames);
+		}
+
+		StreamFence();
+	};
+
+	double render_regular = MeasureNsPerFrame(BUFFER_FRAMES, [&] { render(regular_chains); });
+	double render_streaming = MeasureNsPerFrame(BUFFER_FRAMES, [&] { render(streaming_chains); });
+
+	printf(" Rendering %u frames of %u channels (%u KB):\n", unsigned(BUFFER_FRAMES), unsigned(CHANNELS),
+		unsigned(BUFFER_FRAMES * FRAME_SIZE / 1024));
+	PrintResult("Regular stores", render_regular);
+	PrintResult("Streaming stores", render_streaming, render_regular);
+
+	printf(" Foreground pointer chase right after each buffer, ns per cache line:\n");
+	printf("  %-14s %12s %12s %12s\n", "Working set", "No render", "Regular", "Streaming");
+
+	for (size_t working_set : WORKING_SETS)
+	{
+		PointerChase chase;
+		chase.Init(working_set);
+
+		double results[3];
+
+		for (StoreMode mode : { StoreMode::None, StoreMode::Regular, StoreMode::Streaming })
+		{
+			double total = 0.0;
+
+			for (int round = 0; round < ROUNDS; round++)
+			{
+				chase.Run(); // Load the working set into the cache.
+
+				if (mode == StoreMode::Regular) { render(regular_chains); }
+				if (mode == StoreMode::Streaming) { render(streaming_chains); }
+
+				total += chase.Run();
+			}
+
+			results[int(mode)] = total / ROUNDS;
+		}
+
+		printf("  %8u KB    %12.2f %12.2f %12.2f\n", unsigned(working_set / 1024), results[0], results[1], results[2]);
+	}
+}
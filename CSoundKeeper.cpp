@@ -527,6 +527,9 @@ HRESULT CSoundKeeper::Start()
 		m_sessions[0]->SetPeriodicPlaying(m_cfg_play_seconds);
 		m_sessions[0]->SetPeriodicWaiting(m_cfg_wait_seconds);
 		m_sessions[0]->SetFading(m_cfg_fade_seconds);
+		m_sessions[0]->SetFadeCurve(m_cfg_fade_curve);
+		m_sessions[0]->SetPinkNoiseVoss(m_cfg_pink_noise_voss);
+		m_sessions[0]->SetDecorrelatedNoise(m_cfg_decorrelated_noise);
 		m_sessions[0]->Start();
 	}
 	else
@@ -589,6 +592,9 @@ HRESULT CSoundKeeper::Start()
 			m_sessions[i]->SetPeriodicPlaying(m_cfg_play_seconds);
 			m_sessions[i]->SetPeriodicWaiting(m_cfg_wait_seconds);
 			m_sessions[i]->SetFading(m_cfg_fade_seconds);
+			m_sessions[i]->SetFadeCurve(m_cfg_fade_curve);
+			m_sessions[i]->SetPinkNoiseVoss(m_cfg_pink_noise_voss);
+			m_sessions[i]->SetDecorrelatedNoise(m_cfg_decorrelated_noise);
 			m_sessions[i]->Start();
 		}
 
@@ -884,6 +890,7 @@ void CSoundKeeper::SetStreamTypeDefaults(KeepStreamType stream_type)
 	m_cfg_play_seconds = 0.0;
 	m_cfg_wait_seconds = 0.0;
 	m_cfg_fade_seconds = 0.0;
+	m_cfg_fade_curve = KeepFadeCurve::Quadratic;
 
 	switch (stream_type)
 	{
@@ -892,10 +899,16 @@ void CSoundKeeper::SetStreamTypeDefaults(KeepStreamType stream_type)
 			break;
 		case KeepStreamType::Sine:
 			m_cfg_frequency = 1.0;
+			m_cfg_amplitude = 0.01;
+			m_cfg_fade_seconds = 0.1;
+			break;
+		case KeepStreamType::Subsonic:
+			m_cfg_frequency = 15.0;
 			[[fallthrough]];
 		case KeepStreamType::WhiteNoise:
 		case KeepStreamType::BrownNoise:
 		case KeepStreamType::PinkNoise:
+		case KeepStreamType::ShapedNoise:
 			m_cfg_amplitude = 0.01;
 			m_cfg_fade_seconds = 0.1;
 			[[fallthrough]];
@@ -912,7 +925,7 @@ void CSoundKeeper::ParseStreamArgs(KeepStreamType stream_type, const char* args)
 	while (*p)
 	{
 		if (*p == ' ' || *p == '\t' || *p == '-') { p++; }
-		else if (*p == 'f' || *p == 'a' || *p == 'l' || *p == 'w' || *p == 't')
+		else if (*p == 'f' || *p == 'a' || *p == 'l' || *p == 'w' || *p == 't' || *p == 'c')
 		{
 			char type = *p;
 			p++;
@@ -940,6 +953,10 @@ void CSoundKeeper::ParseStreamArgs(KeepStreamType stream_type, const char* args)
 			{
 				this->SetFading(value);
 			}
+			else if (type == 'c')
+			{
+				this->SetFadeCurve(value < 4.0 ? static_cast<KeepFadeCurve>(int(value)) : KeepFadeCurve::Quadratic);
+			}
 		}
 		else
 		{
@@ -960,6 +977,11 @@ void CSoundKeeper::ParseModeString(const char* args)
 	if (strstr(buf, "digital")) { this->SetDeviceType(KeepDeviceType::Digital); }
 	if (strstr(buf, "kill"))    { this->SetDeviceType(KeepDeviceType::None); }
 	if (strstr(buf, "remote"))  { this->SetAllowRemote(true); }
+	if (strstr(buf, "voss"))    { this->SetPinkNoiseVoss(true); }
+	if (strstr(buf, "decorrelate")) { this->SetDecorrelatedNoise(true); }
+	if (strstr(buf, "fixedpoint")) { CSoundSession::EnableFixedPoint(true); }
+	if (strstr(buf, "minformat")) { CSoundSession::EnableMinimalFormat(true); }
+	if (strstr(buf, "renderahead")) { CSoundSession::EnableRenderAhead(true); }
 
 	if (strstr(buf, "nosleep"))
 	{
@@ -986,6 +1008,13 @@ void CSoundKeeper::ParseModeString(const char* args)
 		}
 	}
 
+#if IS_WIN_CUI
+	// Debug builds can use the original scalar (and double precision) generators to compare them with the vectorized ones.
+	if (strstr(buf, "scalar"))  { CSoundSession::EnableScalarKernels(true); }
+	// And a fixed noise seed makes the generated noise reproducible.
+	if (strstr(buf, "fixedseed")) { CSoundSession::SetNoiseSeed(1); }
+#endif
+
 	if (strstr(buf, "openonly"))
 	{
 		this->SetStreamType(KeepStreamType::None);
@@ -1014,6 +1043,14 @@ void CSoundKeeper::ParseModeString(const char* args)
 	{
 		this->ParseStreamArgs(KeepStreamType::PinkNoise, p+4);
 	}
+	else if (const char* p = strstr(buf, "subsonic"))
+	{
+		this->ParseStreamArgs(KeepStreamType::Subsonic, p+8);
+	}
+	else if (const char* p = strstr(buf, "shaped"))
+	{
+		this->ParseStreamArgs(KeepStreamType::ShapedNoise, p+6);
+	}
 }
 
 HRESULT CSoundKeeper::Main()
@@ -1107,7 +1144,9 @@ HRESULT CSoundKeeper::Main()
 		case KeepStreamType::Sine:      DebugLog("Stream Type: Sine (Frequency: %.3fHz; Amplitude: %.3f%%; Fading: %.3fs).", this->GetFrequency(), this->GetAmplitude() * 100.0, this->GetFading()); break;
 		case KeepStreamType::WhiteNoise:DebugLog("Stream Type: White Noise (Amplitude: %.3f%%; Fading: %.3fs).", this->GetAmplitude() * 100.0, this->GetFading()); break;
 		case KeepStreamType::BrownNoise:DebugLog("Stream Type: Brown Noise (Amplitude: %.3f%%; Fading: %.3fs).", this->GetAmplitude() * 100.0, this->GetFading()); break;
-		case KeepStreamType::PinkNoise: DebugLog("Stream Type: Pink Noise (Amplitude: %.3f%%; Fading: %.3fs).", this->GetAmplitude() * 100.0, this->GetFading()); break;
+		case KeepStreamType::PinkNoise: DebugLog("Stream Type: Pink Noise (Amplitude: %.3f%%; Fading: %.3fs; Method: %s).", this->GetAmplitude() * 100.0, this->GetFading(), this->GetPinkNoiseVoss() ? "Voss-McCartney" : "Paul Kellet"); break;
+		case KeepStreamType::Subsonic:  DebugLog("Stream Type: Subsonic Noise (Cutoff: %.3fHz; Amplitude: %.3f%%; Fading: %.3fs).", this->GetFrequency(), this->GetAmplitude() * 100.0, this->GetFading()); break;
+		case KeepStreamType::ShapedNoise:DebugLog("Stream Type: Shaped Noise (Amplitude: %.3f%%; Fading: %.3fs).", this->GetAmplitude() * 100.0, this->GetFading()); break;
 		default:                        DebugLogError("Unknown Stream Type."); break;
 	}
 
@@ -1120,6 +1159,22 @@ HRESULT CSoundKeeper::Main()
 		DebugLog("Periodicity: Disabled.");
 	}
 
+	if (this->GetStreamType() == KeepStreamType::WhiteNoise || this->GetStreamType() == KeepStreamType::BrownNoise
+		|| this->GetStreamType() == KeepStreamType::PinkNoise)
+	{
+		DebugLog("Decorrelated Channels: %s.", this->GetDecorrelatedNoise() ? "Yes" : "No");
+	}
+
+	if (this->GetFading())
+	{
+		const char* curves[] = { "Quadratic", "Linear", "Cosine", "Exponential" };
+		DebugLog("Fading Curve: %s.", curves[static_cast<int>(this->GetFadeCurve())]);
+	}
+
+	const CpuFeatures& cpu = m_cpu_features;
+	DebugLog("CPU Features:%s%s%s%s%s.", cpu.sse2 ? " SSE2" : "", cpu.sse41 ? " SSE4.1" : "", cpu.avx2 ? " AVX2" : "",
+		cpu.avx512 ? " AVX-512" : "", cpu.neon ? " NEON" : "");
+
 	DebugLog("Sleep With Idle Timer: %s, With System: %s, With Display: %s, With User Lock: %s.",
 		m_cfg_sleep_with_idle_timer ? "Yes" : "No",
 		m_cfg_sleep_with_system ? "Yes" : "No",
@@ -1,9 +1,11 @@
 #pragma once
 
 #include "Common.hpp"
+#include "Common/CpuFeatures.hpp"
 
 enum class KeepDeviceType { None, Primary, Marked, Digital, Analog, All };
-enum class KeepStreamType { None, Zero, Fluctuate, Sine, WhiteNoise, BrownNoise, PinkNoise };
+enum class KeepStreamType { None, Zero, Fluctuate, Sine, WhiteNoise, BrownNoise, PinkNoise, Subsonic, ShapedNoise };
+enum class KeepFadeCurve { Quadratic, Linear, Cosine, Exponential };
 
 class CSoundKeeper;
 
@@ -16,12 +18,17 @@ protected:
 	LONG                    m_ref_count = 1;
 	CriticalSection         m_mutex;
 
+	// Detected once on the main thread, sessions select their kernels for it.
+	CpuFeatures             m_cpu_features = DetectCpuFeatures();
+
 	~CSoundKeeper();
 
 public:
 
 	CSoundKeeper();
 
+	const CpuFeatures& GetCpuFeatures() const { return m_cpu_features; }
+
 	// IUnknown methods
 
 	ULONG STDMETHODCALLTYPE AddRef();
@@ -61,6 +68,9 @@ protected:
 	double                  m_cfg_play_seconds = 0.0;
 	double                  m_cfg_wait_seconds = 0.0;
 	double                  m_cfg_fade_seconds = 0.0;
+	KeepFadeCurve           m_cfg_fade_curve = KeepFadeCurve::Quadratic;
+	bool                    m_cfg_pink_noise_voss = false;
+	bool                    m_cfg_decorrelated_noise = false;
 
 	HRESULT Start();
 	HRESULT Stop();
@@ -97,11 +107,17 @@ public:
 	void SetPeriodicPlaying(double seconds) { m_cfg_play_seconds = seconds; }
 	void SetPeriodicWaiting(double seconds) { m_cfg_wait_seconds = seconds; }
 	void SetFading(double seconds) { m_cfg_fade_seconds = seconds; }
+	void SetFadeCurve(KeepFadeCurve curve) { m_cfg_fade_curve = curve; }
+	void SetPinkNoiseVoss(bool enable) { m_cfg_pink_noise_voss = enable; }
+	void SetDecorrelatedNoise(bool enable) { m_cfg_decorrelated_noise = enable; }
 	double GetFrequency() const { return m_cfg_frequency; }
 	double GetAmplitude() const { return m_cfg_amplitude; }
 	double GetPeriodicPlaying() const { return m_cfg_play_seconds; }
 	double GetPeriodicWaiting() const { return m_cfg_wait_seconds; }
 	double GetFading() const { return m_cfg_fade_seconds; }
+	KeepFadeCurve GetFadeCurve() const { return m_cfg_fade_curve; }
+	bool GetPinkNoiseVoss() const { return m_cfg_pink_noise_voss; }
+	bool GetDecorrelatedNoise() const { return m_cfg_decorrelated_noise; }
 
 	// Set stream type and defaults.
 	void SetStreamTypeDefaults(KeepStreamType stream_type);
@@ -1,6 +1,17 @@
 #include "CSoundSession.hpp"
 
 bool CSoundSession::g_is_leaky_wasapi = false;
+bool CSoundSession::g_use_scalar_kernels = false;
+bool CSoundSession::g_use_fixed_point = false;
+bool CSoundSession::g_use_min_format = false;
+bool CSoundSession::g_use_render_ahead = false;
+uint32_t CSoundSession::g_noise_seed = 0;
+
+CriticalSection CSoundSession::g_scheduler_mutex;
+HANDLE CSoundSession::g_scheduler_thread = NULL;
+bool CSoundSession::g_is_scheduler_running = false;
+AutoResetEvent CSoundSession::g_scheduler_wakeup = false;
+CSoundSession* CSoundSession::g_scheduled_sessions = nullptr;
 
 CSoundSession::CSoundSession(CSoundKeeper* soundkeeper, IMMDevice* endpoint)
 	: m_soundkeeper(soundkeeper), m_endpoint(endpoint)
@@ -8,6 +19,16 @@ CSoundSession::CSoundSession(CSoundKeeper* soundkeeper, IMMDevice* endpoint)
 	m_endpoint->AddRef();
 	m_soundkeeper->AddRef();
 
+	// The sine table is shared by all sessions, so it's initialized here, on the main thread.
+	InitSineTable();
+
+	// Kernels are selected for the CPU once, when the session is created.
+	m_kernels = SelectGeneratorKernels(m_soundkeeper->GetCpuFeatures());
+	DebugLog("Generator kernels: %s.", m_kernels.name);
+
+	// Noise of sessions must not be correlated, so each one gets its own seed unless a fixed one is set.
+	m_noise_seed = g_noise_seed ? g_noise_seed : uint32_t(GetTickCount64()) * 0x9E3779B9 ^ uint32_t(uintptr_t(this));
+
 	if (HRESULT hr = m_endpoint->GetId(&m_device_id); FAILED(hr))
 	{
 		DebugLogError("Unable to get device ID: 0x%08X.", hr);
@@ -18,6 +39,8 @@ CSoundSession::CSoundSession(CSoundKeeper* soundkeeper, IMMDevice* endpoint)
 CSoundSession::~CSoundSession(void)
 {
 	this->Stop();
+	this->DropCycleCache();
+	delete[] m_shaped_memory;
 	if (m_device_id) { CoTaskMemFree(m_device_id); }
 	SafeRelease(m_endpoint);
 	SafeRelease(m_soundkeeper);
@@ -74,17 +97,45 @@ bool CSoundSession::Start()
 
 	this->Stop();
 
-	//
-	// Now create the thread which is going to drive the renderer.
-	m_render_thread = CreateThread(NULL, 0, RenderingThreadEntry, this, 0, NULL);
-	if (m_render_thread == NULL)
+	m_curr_mode = RenderingMode::Rendering;
+	m_play_attempts = 0;
+	m_wait_attempts = 0;
+	m_deadline = 0;
+	m_is_stopped = false;
+
 	{
-		DebugLogError("Unable to create rendering thread: 0x%08X.", GetLastError());
-		return false;
+		ScopedLock scheduler_lock(g_scheduler_mutex);
+
+		//
+		// Now create the thread which is going to drive the renderers, unless it's already running.
+		if (!g_is_scheduler_running)
+		{
+			if (g_scheduler_thread)
+			{
+				// It's exiting after the last session was stopped.
+				WaitForOne(g_scheduler_thread, INFINITE);
+				CloseHandle(g_scheduler_thread);
+			}
+
+			g_scheduler_thread = CreateThread(NULL, 0, SchedulerThreadEntry, NULL, 0, NULL);
+			if (g_scheduler_thread == NULL)
+			{
+				DebugLogError("Unable to create rendering thread: 0x%08X.", GetLastError());
+				return false;
+			}
+
+			g_is_scheduler_running = true;
+		}
+
+		m_next_session = g_scheduled_sessions;
+		g_scheduled_sessions = this;
+		m_is_scheduled = true;
+		m_is_starting = true;
+		g_scheduler_wakeup = true;
 	}
 
-	// Wait until rendering is started.
-	if (WaitForAny({ m_is_started, m_render_thread }, INFINITE) != WAIT_OBJECT_0)
+	// Wait until the rendering thread has serviced the session once. It signals m_is_stopped if the session is finished.
+	if (WaitForAny({ m_is_started, m_is_stopped }, INFINITE) != WAIT_OBJECT_0)
 	{
 		DebugLogError("Unable to start rendering.");
 		this->Stop();
@@ -100,14 +151,23 @@ void CSoundSession::Stop()
 {
 	ScopedLock lock(m_mutex);
 
-	if (m_render_thread)
+	if (m_is_scheduled)
 	{
 		this->DeferNextMode(RenderingMode::Stop);
-		WaitForOne(m_render_thread, INFINITE);
-		CloseHandle(m_render_thread);
-		m_render_thread = NULL;
+		WaitForOne(m_is_stopped, INFINITE);
+		m_is_scheduled = false;
 		this->ResetCurrent();
 		m_interrupt = false;
+
+		ScopedLock scheduler_lock(g_scheduler_mutex);
+
+		if (!g_is_scheduler_running && g_scheduler_thread)
+		{
+			// It was the last session, so the rendering thread exits.
+			WaitForOne(g_scheduler_thread, INFINITE);
+			CloseHandle(g_scheduler_thread);
+			g_scheduler_thread = NULL;
+		}
 	}
 }
 
@@ -117,17 +177,28 @@ void CSoundSession::Stop()
 
 #include <avrt.h>
 
-DWORD APIENTRY CSoundSession::RenderingThreadEntry(LPVOID context)
+DWORD APIENTRY CSoundSession::SchedulerThreadEntry(LPVOID context)
 {
 	DebugThreadName("Rendering");
+	UNUSED(context);
 
-	CSoundSession* renderer = static_cast<CSoundSession*>(context);
-
-	DebugLog("Enter rendering thread. Device ID: '%S'.", renderer->GetDeviceId());
+	DebugLog("Enter rendering thread.");
 
 	if (HRESULT hr = CoInitializeEx(NULL, COINIT_MULTITHREADED | COINIT_DISABLE_OLE1DDE); FAILED(hr))
 	{
 		DebugLogError("Unable to initialize COM in rendering thread: 0x%08X.", hr);
+
+		// Nothing can be rendered, so all sessions are invalid.
+		ScopedLock lock(g_scheduler_mutex);
+		while (CSoundSession* session = g_scheduled_sessions)
+		{
+			g_scheduled_sessions = session->m_next_session;
+			session->m_next_session = nullptr;
+			session->m_curr_mode = RenderingMode::Invalid;
+			session->m_is_started = false;
+			session->m_is_stopped = true;
+		}
+		g_is_scheduler_running = false;
 		return 1;
 	}
 
@@ -141,7 +212,7 @@ DWORD APIENTRY CSoundSession::RenderingThreadEntry(LPVOID context)
 		DebugLogError("Unable to enable MMCSS on rendering thread: 0x%08X.", GetLastError());
 	}
 
-	DWORD result = renderer->RenderingThread();
+	DWORD result = SchedulerThread();
 
 	if (mmcss_handle != NULL)
 	{
@@ -154,46 +225,172 @@ DWORD APIENTRY CSoundSession::RenderingThreadEntry(LPVOID context)
 	return result;
 }
 
-DWORD CSoundSession::RenderingThread()
+//
+// Drive all sessions: sleep until the nearest deadline or an interrupt, then service each session that is due.
+// The thread exits when it has no sessions left.
+DWORD CSoundSession::SchedulerThread()
 {
-	m_is_started = true;
-	m_curr_mode = RenderingMode::Rendering;
-	m_play_attempts = 0;
-	m_wait_attempts = 0;
+	// GetTickCount64() advances by timer ticks, so a wakeup for a deadline can see the time a bit before it.
+	// Sessions that are due within a tick are serviced right away, it's safe to top up a buffer a bit earlier.
+	const ULONGLONG DUE_SLACK_MS = 16;
 
-	DWORD delay = 0;
-	bool loop = true;
+#if IS_WIN_CUI
+	ULONGLONG stats_start = GetTickCount64();
+	DWORD stats_wakeups = 0;
+	DWORD stats_saved_wakeups = 0;
+	ULONGLONG total_saved_wakeups = 0;
+#endif
 
-	while (loop)
+	for (DWORD timeout = 0; ; )
 	{
-		DebugLog("Rendering thread mode: %d. Delay: %d.", m_curr_mode, delay);
+		WaitForOne(g_scheduler_wakeup, timeout);
+
+		// The lock is held only while the list is read or changed, so Start() and Stop() don't wait for services.
+		// Sessions are added only at the head, and only this thread removes them, so the list is walked without it.
+		// Sessions added during the pass are serviced in the next one, they signal the wakeup.
 
-		switch (WaitForOne(m_interrupt, delay))
+		CSoundSession* first_session;
 		{
-		case WAIT_OBJECT_0:
+			ScopedLock lock(g_scheduler_mutex);
+			first_session = g_scheduled_sessions;
+		}
 
-			DebugLog("Set new rendering thread mode: %d.", m_next_mode);
-			m_curr_mode = m_next_mode;
-			break;
+		ULONGLONG next_deadline = INFINITE_DEADLINE;
+		DWORD sessions_count = 0;
+		DWORD serviced_count = 0;
+
+		for (CSoundSession* session = first_session, *next_session; session; session = next_session)
+		{
+			next_session = session->m_next_session;
 
-		case WAIT_TIMEOUT:
+			ServiceResult result = session->Service(GetTickCount64() + DUE_SLACK_MS);
+			serviced_count += (result == ServiceResult::Serviced);
 
-			break;
+			if (result == ServiceResult::Finished)
+			{
+				// Stop() can free the session as soon as it's signaled, so it's unlinked first.
+				ScopedLock lock(g_scheduler_mutex);
+				CSoundSession** link = &g_scheduled_sessions;
+				while (*link != session) { link = &(*link)->m_next_session; }
+				*link = session->m_next_session;
+				session->m_next_session = nullptr;
+				session->m_is_stopped = true;
+				continue;
+			}
 
-		default:
+			if (session->m_is_starting)
+			{
+				// Let Start() return.
+				session->m_is_starting = false;
+				session->m_is_started = true;
+			}
 
-			// Shouldn't happen.
-			m_curr_mode = RenderingMode::Invalid;
-			break;
+			next_deadline = std::min(next_deadline, session->m_deadline);
+			sessions_count++;
+		}
+
+		{
+			ScopedLock lock(g_scheduler_mutex);
+			if (!g_scheduled_sessions)
+			{
+				g_is_scheduler_running = false;
+				return 0;
+			}
+		}
+
+		ULONGLONG now = GetTickCount64();
+		timeout = next_deadline == INFINITE_DEADLINE ? INFINITE
+			: static_cast<DWORD>(next_deadline > now ? std::min(next_deadline - now, ULONGLONG(INFINITE - 1)) : 0);
+
+#if IS_WIN_CUI
+		// With a thread per session, each serviced session would have had its own wakeup.
+		stats_wakeups++;
+		stats_saved_wakeups += serviced_count > 1 ? serviced_count - 1 : 0;
+		if (ULONGLONG elapsed = now - stats_start; elapsed >= 60000)
+		{
+			total_saved_wakeups += stats_saved_wakeups;
+			DebugLog("Rendering wakeups: %.1f per minute (%u sessions). Saved by coalescing: %.1f per minute, %llu in total.",
+				stats_wakeups * 60000.0 / elapsed, sessions_count, stats_saved_wakeups * 60000.0 / elapsed, total_saved_wakeups);
+			stats_start += elapsed;
+			stats_wakeups = 0;
+			stats_saved_wakeups = 0;
+		}
+#else
+		UNUSED(sessions_count);
+		UNUSED(serviced_count);
+#endif
+	}
+}
+
+//
+// Run the state machine of the session if it's interrupted or its deadline (minus its slack) is before the due time.
+// When it's finished, it's removed from the scheduler.
+CSoundSession::ServiceResult CSoundSession::Service(ULONGLONG due_time)
+{
+	DWORD delay = 0;
+
+	if (m_interrupt.GetSet(false))
+	{
+		DebugLog("Set new rendering mode: %d. Device ID: '%S'.", m_next_mode, this->GetDeviceId());
+
+		if (m_audio_client)
+		{
+			// We're done, exit the loop.
+			this->StopRendering();
+			m_curr_mode = m_next_mode;
+			if (g_is_leaky_wasapi && m_curr_mode == RenderingMode::WaitExclusive)
+			{
+				delay = 30;
+			}
+		}
+		else if (m_exclusive_session)
+		{
+			// The exclusive mode session is changed.
+			m_exclusive_session->UnregisterAudioSessionNotification(this);
+			SafeRelease(m_exclusive_session);
+			m_curr_mode = m_next_mode;
+			if (m_curr_mode == RenderingMode::WaitExclusive)
+			{
+				delay = 500;
+			}
+		}
+		else
+		{
+			m_curr_mode = m_next_mode;
+		}
+	}
+	else if (m_deadline - m_deadline_slack > due_time)
+	{
+		return ServiceResult::Waiting;
+	}
+	else if (m_audio_client)
+	{
+		// Provide the next buffer of samples.
+		if (SUCCEEDED(this->Render()))
+		{
+			this->SetRenderDeadline();
+			return ServiceResult::Serviced;
 		}
-		delay = 0;
+
+		this->StopRendering();
+		m_curr_mode = RenderingMode::Retry;
+	}
+
+	while (!delay)
+	{
+		DebugLog("Rendering mode: %d. Device ID: '%S'.", m_curr_mode, this->GetDeviceId());
 
 		switch (m_curr_mode)
 		{
 		case RenderingMode::Rendering:
 
 			DebugLog("Render. Device State: %d.", this->GetDeviceState());
-			m_curr_mode = this->Rendering();
+			m_curr_mode = this->StartRendering();
+			if (m_curr_mode == RenderingMode::Rendering)
+			{
+				this->SetRenderDeadline();
+				return ServiceResult::Serviced;
+			}
 			if (g_is_leaky_wasapi && m_curr_mode == RenderingMode::WaitExclusive)
 			{
 				delay = 30;
@@ -216,6 +413,12 @@ DWORD CSoundSession::RenderingThread()
 			{
 				DebugLog("Wait until exclusive session is finised.");
 				m_curr_mode = this->WaitExclusive();
+				if (m_exclusive_session)
+				{
+					// Wait for a notification that the stream is inactive.
+					this->SetDeadline(INFINITE);
+					return ServiceResult::Serviced;
+				}
 				if (m_curr_mode == RenderingMode::WaitExclusive)
 				{
 					delay = 500;
@@ -244,13 +447,30 @@ DWORD CSoundSession::RenderingThread()
 		// case RenderingMode::Invalid:
 		default:
 
-			loop = false;
-			break;
+			DebugLog("Leave rendering. Device ID: '%S'.", this->GetDeviceId());
+			m_is_started = false;
+			return ServiceResult::Finished;
 		}
 	}
 
-	m_is_started = false;
-	return m_curr_mode == RenderingMode::Invalid;
+	this->SetDeadline(delay);
+	return ServiceResult::Serviced;
+}
+
+//
+// Set the deadline of the next Render(). Sessions that share the rendering thread are brought together: a session
+// can be topped up to half of its buffer earlier when the thread is awake for another one anyway. After that, their
+// deadlines stay close, since buffers of the same length are played at the same pace.
+void CSoundSession::SetRenderDeadline()
+{
+	if (m_stream_type == KeepStreamType::None)
+	{
+		this->SetDeadline(INFINITE);
+		return;
+	}
+
+	DWORD timeout = this->GetRenderTimeout();
+	this->SetDeadline(timeout, std::min(m_buffer_size_in_ms / 2, timeout));
 }
 
 CSoundSession::RenderingMode CSoundSession::TryOpenDevice()
@@ -302,13 +522,18 @@ CSoundSession::RenderingMode CSoundSession::TryOpenDevice()
 	return RenderingMode::Rendering;
 }
 
-CSoundSession::RenderingMode CSoundSession::Rendering()
+//
+// Open the stream and start playing. Returns the next mode on errors, the stream is closed then.
+CSoundSession::RenderingMode CSoundSession::StartRendering()
 {
 	RenderingMode exit_mode;
 	HRESULT hr;
 
 	m_play_attempts++;
 
+	bool is_started = false;
+	defer [&] { if (!is_started) { this->StopRendering(); } };
+
 	// -------------------------------------------------------------------------
 	// Rendering Init
 	// -------------------------------------------------------------------------
@@ -324,7 +549,6 @@ CSoundSession::RenderingMode CSoundSession::Rendering()
 		DebugLogError("Unable to activate audio client: 0x%08X.", hr);
 		return exit_mode;
 	}
-	defer [&] { SafeRelease(m_audio_client); };
 
 	{
 		// Get output format. Don't rely on it much since WASAPI reporting is not always accurate:
@@ -374,27 +598,73 @@ CSoundSession::RenderingMode CSoundSession::Rendering()
 			return exit_mode;
 		}
 
-		m_channels_count = mix_format->nChannels;
-		m_frame_size = mix_format->nBlockAlign;
-
-		// Noise generation works best with the 48000Hz sample rate.
-		if (m_stream_type == KeepStreamType::WhiteNoise || m_stream_type == KeepStreamType::BrownNoise || m_stream_type == KeepStreamType::PinkNoise)
-		{
-			DebugLog("Using 48000Hz sample rate for noise generation.");
-			mix_format->nSamplesPerSec = 48000;
-			mix_format->nAvgBytesPerSec= mix_format->nSamplesPerSec * mix_format->nBlockAlign;
-		}
-
 		m_sample_rate = mix_format->nSamplesPerSec;
 
 		// Use smaller buffer if leaky WASAPI.
 		// Rendering loop relies on not precise enough system timer so minimum viable buffer is 40ms.
 		m_buffer_size_in_ms = g_is_leaky_wasapi ? 100 : 1000;
 
-		// Initialize WASAPI in timer driven mode.
-		hr = m_audio_client->Initialize(AUDCLNT_SHAREMODE_SHARED,
-			AUDCLNT_STREAMFLAGS_NOPERSIST | AUDCLNT_STREAMFLAGS_AUTOCONVERTPCM /*| AUDCLNT_STREAMFLAGS_SRC_DEFAULT_QUALITY*/,
-			static_cast<UINT64>(m_buffer_size_in_ms) * 10000, 0, mix_format, NULL);
+		const DWORD stream_flags = AUDCLNT_STREAMFLAGS_NOPERSIST | AUDCLNT_STREAMFLAGS_AUTOCONVERTPCM /*| AUDCLNT_STREAMFLAGS_SRC_DEFAULT_QUALITY*/;
+		bool is_int16 = false;
+		bool use_mix_format = true;
+
+		// Decorrelated noise needs all channels.
+		bool is_multichannel_noise = m_decorrelated_noise && (m_stream_type == KeepStreamType::WhiteNoise
+			|| m_stream_type == KeepStreamType::BrownNoise || m_stream_type == KeepStreamType::PinkNoise);
+
+		if (g_use_min_format && !is_multichannel_noise)
+		{
+			// Mono at the mixing rate, so the engine does upmixing. Samples are 16-bit except Fluctuate, which needs
+			// float samples to keep its impulses as small as the output format allows.
+			WAVEFORMATEX min_format = {};
+			is_int16 = (m_stream_type != KeepStreamType::Fluctuate);
+			min_format.wFormatTag = is_int16 ? WAVE_FORMAT_PCM : WAVE_FORMAT_IEEE_FLOAT;
+			min_format.nChannels = 1;
+			min_format.nSamplesPerSec = m_sample_rate;
+			min_format.wBitsPerSample = is_int16 ? 16 : 32;
+			min_format.nBlockAlign = min_format.nChannels * min_format.wBitsPerSample / 8;
+			min_format.nAvgBytesPerSec = min_format.nSamplesPerSec * min_format.nBlockAlign;
+
+			// Initialize WASAPI in timer driven mode.
+			hr = m_audio_client->Initialize(AUDCLNT_SHAREMODE_SHARED, stream_flags,
+				static_cast<UINT64>(m_buffer_size_in_ms) * 10000, 0, &min_format, NULL);
+
+			if (SUCCEEDED(hr) || hr == AUDCLNT_E_DEVICE_IN_USE || hr == HRESULT_FROM_WIN32(ERROR_BUSY))
+			{
+				m_channels_count = min_format.nChannels;
+				m_frame_size = min_format.nBlockAlign;
+				use_mix_format = false;
+			}
+			else
+			{
+				DebugLogWarning("Minimal format is rejected: 0x%08X. Using the mixing format.", hr);
+				is_int16 = false;
+
+				// The audio client is in an unknown state after a failed initialization, so a fresh one is used.
+				SafeRelease(m_audio_client);
+				hr = m_endpoint->Activate(__uuidof(IAudioClient), CLSCTX_INPROC_SERVER, NULL, reinterpret_cast<void **>(&m_audio_client));
+				if (FAILED(hr))
+				{
+					DebugLogError("Unable to activate audio client: 0x%08X.", hr);
+					return exit_mode;
+				}
+			}
+		}
+
+		if (use_mix_format)
+		{
+			m_channels_count = mix_format->nChannels;
+			m_frame_size = mix_format->nBlockAlign;
+
+			// Initialize WASAPI in timer driven mode.
+			hr = m_audio_client->Initialize(AUDCLNT_SHAREMODE_SHARED, stream_flags,
+				static_cast<UINT64>(m_buffer_size_in_ms) * 10000, 0, mix_format, NULL);
+		}
+
+		m_chains = m_kernels.select_chains(m_channels_count, m_frame_size, is_int16);
+		m_streaming_chains = SelectStreamingBlockChains(m_channels_count, m_frame_size, is_int16);
+		DebugLog("Stream format: %uHz, %u channels, %u bytes per frame%s.", m_sample_rate, m_channels_count, m_frame_size,
+			m_chains.is_packed ? " (specialized fan-out)" : "");
 	}
 
 	if (FAILED(hr))
@@ -436,7 +706,6 @@ CSoundSession::RenderingMode CSoundSession::Rendering()
 		DebugLogError("Unable to get new render client: 0x%08X.", hr);
 		return exit_mode;
 	}
-	defer [&] { m_render_client->Release(); };
 
 	//
 	// Register for session and endpoint change notifications.  
@@ -446,21 +715,27 @@ CSoundSession::RenderingMode CSoundSession::Rendering()
 		DebugLogError("Unable to retrieve session control: 0x%08X.", hr);
 		return exit_mode;
 	}
-	defer [&] { m_audio_session_control->Release(); };
 	hr = m_audio_session_control->RegisterAudioSessionNotification(this);
 	if (FAILED(hr))
 	{
 		DebugLogError("Unable to register for stream switch notifications: 0x%08X.", hr);
+		SafeRelease(m_audio_session_control);
 		return exit_mode;
 	}
-	defer [&] { m_audio_session_control->UnregisterAudioSessionNotification(this); };
 
 	// -------------------------------------------------------------------------
-	// Rendering Loop
+	// Rendering Start
 	// -------------------------------------------------------------------------
 
 	DebugLog("Starting rendering...");
 
+	this->PrepareRendering();
+
+	if (g_use_render_ahead && m_render_frames && !this->StartRenderAhead())
+	{
+		DebugLogWarning("Render-ahead is not available, frames are rendered on the rendering thread.");
+	}
+
 	// We need to pre-roll one buffer of data into the pipeline before starting.
 	hr = this->Render();
 	if (FAILED(hr))
@@ -479,39 +754,32 @@ CSoundSession::RenderingMode CSoundSession::Rendering()
 	DebugLog("Enter rendering loop.");
 
 	m_play_attempts = 0;
+	is_started = true;
+	return RenderingMode::Rendering;
+}
 
-	DWORD timeout = m_stream_type == KeepStreamType::None ? INFINITE : (m_buffer_size_in_ms / 2 + m_buffer_size_in_ms / 4);
-	for (bool working = true; working; ) switch (WaitForOne(m_interrupt, timeout))
+//
+// Stop playing and close the stream.
+void CSoundSession::StopRendering()
+{
+	if (!m_audio_client)
 	{
-	case WAIT_TIMEOUT: // Timeout.
-
-		// Provide the next buffer of samples.
-		hr = this->Render();
-		if (FAILED(hr))
-		{
-			working = false;
-		}
-		break;
-
-	case WAIT_OBJECT_0 + 0: // m_interrupt.
-
-		// We're done, exit the loop.
-		exit_mode = m_next_mode;
-		working = false;
-		break;
-
-	default:
-
-		// Should never happen.
-		exit_mode = RenderingMode::Invalid;
-		working = false;
-		break;
+		return;
 	}
 
 	DebugLog("Leave rendering loop. Stopping audio client...");
 
 	m_audio_client->Stop();
-	return exit_mode;
+	this->StopRenderAhead();
+
+	if (m_audio_session_control)
+	{
+		m_audio_session_control->UnregisterAudioSessionNotification(this);
+		SafeRelease(m_audio_session_control);
+	}
+
+	SafeRelease(m_render_client);
+	SafeRelease(m_audio_client);
 }
 
 CSoundSession::SampleType CSoundSession::ParseSampleType(WAVEFORMATEX* format)
@@ -574,6 +842,186 @@ CSoundSession::SampleType CSoundSession::ParseSampleType(WAVEFORMATEX* format)
 	return result;
 }
 
+void CSoundSession::PrepareRendering()
+{
+	// Periodicity schedule.
+
+	m_play_frames = static_cast<uint64_t>(m_play_seconds * m_sample_rate);
+	m_wait_frames = static_cast<uint64_t>(m_wait_seconds * m_sample_rate);
+	m_fade_frames = static_cast<uint64_t>(m_fade_seconds * m_sample_rate);
+
+	if (!m_wait_frames && !m_fade_frames)
+	{
+		m_play_frames = 0;
+	}
+	else if (!m_play_frames)
+	{
+		m_wait_frames = 0;
+	}
+
+	if (m_play_frames)
+	{
+		m_fade_frames = std::min(m_fade_frames, m_play_frames / 2);
+	}
+
+	m_period_frames = m_play_frames + m_wait_frames;
+
+	if (m_period_frames)
+	{
+		m_curr_frame %= m_period_frames;
+	}
+
+	// Generator parameters.
+
+	m_phase_increment = SinePhaseIncrement(std::min(m_frequency, m_sample_rate / 2.0), m_sample_rate);
+	m_once_in_frames = m_frequency ? std::max(uint64_t(double(m_sample_rate) / m_frequency), 2ULL) : 0;
+
+	// Noise filters are derived from the sample rate, so noise is the same at any rate and doesn't need resampling.
+	m_pink_filter = MakePinkNoiseFilter(m_sample_rate);
+	m_brown_filter = MakeBrownNoiseFilter(m_sample_rate);
+	m_pink_rows = GetPinkNoiseRows(m_sample_rate);
+
+	if (m_stream_type == KeepStreamType::Subsonic && m_frequency)
+	{
+		m_subsonic_filter = MakeSubsonicFilter(m_frequency, m_sample_rate);
+	}
+
+	delete[] m_shaped_memory;
+	m_shaped_memory = nullptr;
+
+	if (m_stream_type == KeepStreamType::ShapedNoise && m_amplitude)
+	{
+		m_shaped_memory = new float[GetShapedNoiseMemorySize(GetShapedNoiseFftSize(m_sample_rate))];
+		if (m_shaped_memory)
+		{
+			InitShapedNoise(m_shaped_noise, m_shaped_memory, m_sample_rate);
+		}
+		else
+		{
+			DebugLogError("Unable to allocate memory for shaped noise.");
+		}
+	}
+
+	// Sine cycle cache. The format may be different now, so the cache is built again when it's needed.
+
+	// Output frames are cached when they fit the budget, so steady parts are plain copies. Otherwise one mono cycle
+	// is cached, it still saves the sine generation. The budget fits a mono cycle of 1 Hz at 192 kHz.
+
+	const UINT32 CYCLE_CACHE_BUDGET = 1 << 20;
+	double cycle_frames = m_frequency ? m_sample_rate / m_frequency : 0.0;
+
+	this->DropCycleCache();
+	m_cycle_frames = 0;
+
+	if (!g_use_scalar_kernels && cycle_frames >= 2 && cycle_frames == floor(cycle_frames))
+	{
+		m_cycle_frame_size = (cycle_frames * m_frame_size <= CYCLE_CACHE_BUDGET) ? m_frame_size : UINT32(sizeof(float));
+
+		if (cycle_frames * m_cycle_frame_size <= CYCLE_CACHE_BUDGET)
+		{
+			m_cycle_frames = UINT32(cycle_frames);
+			m_cycle_frame %= m_cycle_frames;
+		}
+		else if (m_stream_type == KeepStreamType::Sine && m_amplitude)
+		{
+			DebugLogWarning("Sine cycle is too long to be cached: %u frames.", UINT32(cycle_frames));
+		}
+	}
+
+	// Renderer of the stream. Nothing is rendered when the stream is inaudible.
+
+	m_render_frames = nullptr;
+	bool is_multichannel = m_decorrelated_noise && m_channels_count > 1;
+
+	switch (m_stream_type)
+	{
+		case KeepStreamType::Fluctuate:
+			if (m_frequency) { m_render_frames = &CSoundSession::RenderImpulses; }
+			break;
+		case KeepStreamType::Sine:
+			if (m_frequency && m_amplitude)
+			{
+				m_render_frames = g_use_scalar_kernels ? &CSoundSession::RenderSignal<Generator::SineTable>
+					: m_cycle_frames ? &CSoundSession::RenderSignal<Generator::SineCached>
+					: g_use_fixed_point ? &CSoundSession::RenderSignal<Generator::SineFixed>
+					: &CSoundSession::RenderSignal<Generator::Sine>;
+			}
+			break;
+		case KeepStreamType::WhiteNoise:
+			if (m_amplitude)
+			{
+				m_render_frames = is_multichannel ? &CSoundSession::RenderSignal<Generator::WhiteNoiseLanes>
+					: (g_use_fixed_point && !g_use_scalar_kernels) ? &CSoundSession::RenderSignal<Generator::WhiteNoiseFixed>
+					: &CSoundSession::RenderSignal<Generator::WhiteNoise>;
+			}
+			break;
+		case KeepStreamType::BrownNoise:
+			if (m_amplitude)
+			{
+				m_render_frames = is_multichannel ? &CSoundSession::RenderSignal<Generator::BrownNoiseLanes>
+					: (g_use_fixed_point && !g_use_scalar_kernels) ? &CSoundSession::RenderSignal<Generator::BrownNoiseFixed>
+					: &CSoundSession::RenderSignal<Generator::BrownNoise>;
+			}
+			break;
+		case KeepStreamType::PinkNoise:
+			if (m_amplitude)
+			{
+				// The single precision filter is faster only when it's vectorized. The fixed-point one is always Voss-McCartney.
+				m_render_frames = is_multichannel ? (m_pink_noise_voss ? &CSoundSession::RenderSignal<Generator::PinkNoiseVossLanes> : &CSoundSession::RenderSignal<Generator::PinkNoiseLanes>)
+					: (g_use_fixed_point && !g_use_scalar_kernels) ? &CSoundSession::RenderSignal<Generator::PinkNoiseFixed>
+					: m_pink_noise_voss ? &CSoundSession::RenderSignal<Generator::PinkNoiseVoss>
+					: (IS_SIMD && !g_use_scalar_kernels) ? &CSoundSession::RenderSignal<Generator::PinkNoiseFloat>
+					: &CSoundSession::RenderSignal<Generator::PinkNoise>;
+			}
+			break;
+		case KeepStreamType::Subsonic:
+			if (m_frequency && m_amplitude) { m_render_frames = &CSoundSession::RenderSignal<Generator::SubsonicNoise>; }
+			break;
+		case KeepStreamType::ShapedNoise:
+			if (m_shaped_memory) { m_render_frames = &CSoundSession::RenderSignal<Generator::ShapedNoise>; }
+			break;
+		default:
+			break;
+	}
+}
+
+//
+// Get kind of the segment that starts at the current frame and its length (not more than max_frames).
+CSoundSession::Segment CSoundSession::GetSegment(UINT32 max_frames, UINT32& frames) const
+{
+	Segment segment;
+	uint64_t segment_end;
+
+	if (m_curr_frame < m_fade_frames)
+	{
+		segment = Segment::FadeIn;
+		segment_end = m_fade_frames;
+	}
+	else if (!m_period_frames)
+	{
+		segment = Segment::Steady;
+		segment_end = m_curr_frame + max_frames;
+	}
+	else if (m_curr_frame < m_play_frames - m_fade_frames)
+	{
+		segment = Segment::Steady;
+		segment_end = m_play_frames - m_fade_frames;
+	}
+	else if (m_curr_frame < m_play_frames)
+	{
+		segment = Segment::FadeOut;
+		segment_end = m_play_frames;
+	}
+	else
+	{
+		segment = Segment::Silence;
+		segment_end = m_period_frames;
+	}
+
+	frames = static_cast<UINT32>(std::min(segment_end - m_curr_frame, uint64_t(max_frames)));
+	return segment;
+}
+
 HRESULT CSoundSession::Render()
 {
 	HRESULT hr = S_OK;
@@ -596,12 +1044,25 @@ HRESULT CSoundSession::Render()
 
 	// Calculate the number of frames available. It can be 0 right after waking PC up after sleeping.
 	UINT32 need_frames = m_buffer_size_in_frames - padding;
+	m_filled_frames = padding;
 	if (need_frames == 0)
 	{
 		DebugLogWarning("None samples were consumed. Was PC sleeping?");
 		return S_OK;
 	}
 
+	if (m_ahead_thread)
+	{
+		// Only frames that are already rendered can be written. The rest is written on the next wakeup.
+		UINT32 ready_frames = m_ahead_write - m_ahead_read;
+		if (ready_frames < need_frames)
+		{
+			DebugLogWarning("Render-ahead is late: %u of %u frames are ready.", ready_frames, need_frames);
+			need_frames = ready_frames;
+			if (need_frames == 0) { return S_OK; }
+		}
+	}
+
 	BYTE* p_data;
 	hr = m_render_client->GetBuffer(need_frames, &p_data);
 	if (FAILED(hr))
@@ -614,214 +1075,658 @@ HRESULT CSoundSession::Render()
 
 	DWORD render_flags = NULL;
 
-	uint64_t play_frames = static_cast<uint64_t>(m_play_seconds * m_sample_rate);
-	uint64_t wait_frames = static_cast<uint64_t>(m_wait_seconds * m_sample_rate);
-	uint64_t fade_frames = static_cast<uint64_t>(m_fade_seconds * m_sample_rate);
-
-	if (!wait_frames && !fade_frames)
-	{
-		play_frames = 0;
-	}
-	else if (!play_frames)
-	{
-		wait_frames = 0;
-	}
+	UINT32 frames = 0;
 
-	if (play_frames)
+	if (!m_render_frames)
 	{
-		fade_frames = std::min(fade_frames, play_frames / 2);
+		// ZeroMemory(p_data, static_cast<SIZE_T>(m_frame_size) * need_frames);
+		render_flags = AUDCLNT_BUFFERFLAGS_SILENT;
 	}
-
-	uint64_t period_frames = play_frames + wait_frames;
-
-	if (period_frames && play_frames <= m_curr_frame && (m_curr_frame + need_frames) <= period_frames)
+	else if (!m_ahead_thread && this->GetSegment(need_frames, frames) == Segment::Silence && frames == need_frames)
 	{
 		// Just silence whole time.
 		render_flags = AUDCLNT_BUFFERFLAGS_SILENT;
-		m_curr_frame = (m_curr_frame + need_frames) % period_frames;
+		m_curr_frame = (m_curr_frame + need_frames) % m_period_frames;
 	}
-	else if (m_stream_type == KeepStreamType::Fluctuate && m_frequency)
+	else
 	{
-		uint64_t once_in_frames = std::max(uint64_t(double(m_sample_rate) / m_frequency), 2ULL);
-
-		for (size_t i = 0; i < need_frames; i++)
+#if IS_WIN_CUI
+		LARGE_INTEGER start_time, end_time, frequency;
+		QueryPerformanceCounter(&start_time);
+#endif
+
+		if (m_ahead_thread)
+		{
+			this->ReadAhead(p_data, need_frames);
+		}
+		else if (!(this->*m_render_frames)(p_data, need_frames))
 		{
-			uint32_t sample = 0;
+			render_flags = AUDCLNT_BUFFERFLAGS_SILENT;
+		}
 
-			if ((!period_frames || m_curr_frame < play_frames) && m_curr_frame % once_in_frames == 0)
-			{
-				// 0x38000100 = 3.051851E-5 = 1.0/32767. Minimal 16-bit deviation from 0.
-				// 0x34000001 = 1.192093E-7 = 1.0/8388607. Minimal 24-bit deviation from 0.
-				sample = (m_out_sample_type == SampleType::Int16) ? 0x38000100 : 0x34000001;
+#if IS_WIN_CUI
+		QueryPerformanceCounter(&end_time);
+		QueryPerformanceFrequency(&frequency);
+		double ns_per_frame = double(end_time.QuadPart - start_time.QuadPart) * 1e9 / double(frequency.QuadPart) / need_frames;
+		TraceLog("%s %u frames (%s): %.2f ns/frame.", m_ahead_thread ? "Copied" : "Generated", need_frames,
+			g_use_scalar_kernels ? "scalar" : g_use_fixed_point ? "fixed-point" : m_kernels.name, ns_per_frame);
+#endif
+	}
 
-				// Negate each odd time.
-				if ((m_curr_frame / once_in_frames) & 1)
-				{
-					sample |= 0x80000000;
-				}
-			}
+	hr = m_render_client->ReleaseBuffer(need_frames, render_flags);
+	if (FAILED(hr))
+	{
+		DebugLogError("Failed to release buffer: 0x%08X.", hr);
+		return hr;
+	}
 
-			for (size_t j = 0; j < m_channels_count; j++)
-			{
-				*reinterpret_cast<uint32_t*>(p_data + j * sizeof(float)) = sample;
-			}
+	m_filled_frames = padding + need_frames;
+	return S_OK;
+}
+
+//
+// Time until the next Render(). The engine plays buffered frames at the sample rate, so the thread sleeps until only
+// a margin of them is left. The margin covers a late wakeup: waits end on a system timer tick (up to 15.6ms late),
+// and large buffers keep a bit more for a thread that is slow to be scheduled on a busy system.
+DWORD CSoundSession::GetRenderTimeout() const
+{
+	const UINT32 MIN_MARGIN_MS = 20;
+	const UINT32 MIN_TIMEOUT_MS = 10;
+
+	// Buffers below 80ms keep a quarter of their length, as the rendering loop always did.
+	UINT32 margin_ms = std::min(std::max(m_buffer_size_in_ms / 8, MIN_MARGIN_MS), m_buffer_size_in_ms / 4);
+	UINT32 filled_ms = static_cast<UINT32>(uint64_t(m_filled_frames) * 1000 / m_sample_rate);
+
+	// When the buffer is almost empty (e.g. the render-ahead thread is late), it's topped up soon but without spinning.
+	return std::max(filled_ms > margin_ms ? filled_ms - margin_ms : 0, MIN_TIMEOUT_MS);
+}
+
+//
+// Start the render-ahead thread. The ring is filled before it's started, so the first buffer is ready.
+bool CSoundSession::StartRenderAhead()
+{
+	// The ring holds a whole buffer, so the rendering thread never has to wait for the producer after a wakeup.
+	m_ahead_frames = 1;
+	while (m_ahead_frames < m_buffer_size_in_frames) { m_ahead_frames *= 2; }
+
+	m_ahead_ring = new BYTE[static_cast<SIZE_T>(m_frame_size) * m_ahead_frames];
+	if (!m_ahead_ring)
+	{
+		DebugLogError("Unable to allocate render-ahead ring.");
+		return false;
+	}
+
+	m_ahead_read = 0;
+	m_ahead_write = 0;
+	m_ahead_stop = false;
+	this->RenderAhead();
+
+	m_ahead_thread = CreateThread(NULL, 0, RenderAheadThreadEntry, this, 0, NULL);
+	if (m_ahead_thread == NULL)
+	{
+		DebugLogError("Unable to create render-ahead thread: 0x%08X.", GetLastError());
+		this->StopRenderAhead();
+		return false;
+	}
+
+	DebugLog("Render-ahead ring: %u frames.", m_ahead_frames);
+	return true;
+}
+
+//
+// Stop the render-ahead thread and free the ring. Frames that are not played yet are dropped.
+void CSoundSession::StopRenderAhead()
+{
+	if (m_ahead_thread)
+	{
+		m_ahead_stop = true;
+		WaitForOne(m_ahead_thread, INFINITE);
+		CloseHandle(m_ahead_thread);
+		m_ahead_thread = NULL;
+	}
+
+	delete[] m_ahead_ring;
+	m_ahead_ring = nullptr;
+	m_ahead_frames = 0;
+}
+
+DWORD APIENTRY CSoundSession::RenderAheadThreadEntry(LPVOID context)
+{
+	DebugThreadName("Render-ahead");
+
+	CSoundSession* renderer = static_cast<CSoundSession*>(context);
+
+	// Frames are rendered a buffer ahead, so it's not time critical. Let it wait for other threads and run on
+	// efficiency cores, the rendering thread with MMCSS only copies ready frames.
+	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+	SetCurrentThreadEcoQoS(true);
+
+	while (WaitForAny({ renderer->m_ahead_stop, renderer->m_ahead_wakeup }, INFINITE) == WAIT_OBJECT_0 + 1)
+	{
+		renderer->RenderAhead();
+	}
+
+	return 0;
+}
+
+//
+// Fill free space of the ring. Each part is published as soon as it's rendered, so the reader gets it sooner.
+void CSoundSession::RenderAhead()
+{
+	const UINT32 part_frames = std::max(m_ahead_frames / 4, 1U);
+
+	UINT32 write = m_ahead_write;
+
+	for (UINT32 free_frames; (free_frames = m_ahead_frames - (write - m_ahead_read)) != 0; )
+	{
+		UINT32 index = write & (m_ahead_frames - 1);
+		UINT32 frames = std::min({ free_frames, m_ahead_frames - index, part_frames });
+		BYTE* p_data = m_ahead_ring + static_cast<SIZE_T>(m_frame_size) * index;
+
+		if (!(this->*m_render_frames)(p_data, frames))
+		{
+			ZeroMemory(p_data, static_cast<SIZE_T>(m_frame_size) * frames);
+		}
+
+		write += frames;
+		m_ahead_write = write;
+	}
+}
+
+//
+// Copy rendered frames from the ring and let the producer render more.
+void CSoundSession::ReadAhead(BYTE* p_data, UINT32 frames)
+{
+	bool is_streaming = this->IsStreaming(p_data, frames);
+	UINT32 read = m_ahead_read;
+
+	for (UINT32 done_frames = 0, part_frames = 0; done_frames < frames; done_frames += part_frames)
+	{
+		UINT32 index = read & (m_ahead_frames - 1);
+		part_frames = std::min(frames - done_frames, m_ahead_frames - index);
 
-			p_data += m_frame_size;
-			m_curr_frame++;
-			if (period_frames) { m_curr_frame %= period_frames; }
+		BYTE* p_part = p_data + static_cast<SIZE_T>(m_frame_size) * done_frames;
+		const BYTE* p_ring = m_ahead_ring + static_cast<SIZE_T>(m_frame_size) * index;
+		SIZE_T size = static_cast<SIZE_T>(m_frame_size) * part_frames;
+
+		if (is_streaming)
+		{
+			CopyStreaming(p_part, p_ring, size);
 		}
+		else
+		{
+			memcpy(p_part, p_ring, size);
+		}
+
+		read += part_frames;
+	}
+
+	if (is_streaming)
+	{
+		StreamFence();
 	}
-	else if (m_stream_type == KeepStreamType::Sine && m_frequency && m_amplitude)
+
+	m_ahead_read = read;
+	m_ahead_wakeup = true;
+}
+
+//
+// Volume at the fade position (0 is silence, 1 is full volume).
+static double GetFadeVolume(KeepFadeCurve curve, double position)
+{
+	switch (curve)
 	{
-		double theta_increment = (std::min(m_frequency, m_sample_rate / 2.0) * (M_PI*2)) / double(m_sample_rate);
+		case KeepFadeCurve::Linear:         return position;
+		case KeepFadeCurve::Cosine:         return (1.0 - cos(M_PI * position)) / 2;
+		case KeepFadeCurve::Exponential:    return (exp(position * log(1000.0)) - 1.0) / (1000.0 - 1.0); // 60 dB range.
+		default:                            return position * position;
+	}
+}
 
-		for (size_t i = 0; i < need_frames; i++)
+//
+// Envelope that starts at the given fade position and moves by the step each frame.
+static FadeEnvelope MakeFadeEnvelope(KeepFadeCurve curve, double position, double step)
+{
+	FadeEnvelope envelope;
+	envelope.gain = GetFadeVolume(curve, position);
+	envelope.prev_gain = GetFadeVolume(curve, position - step);
+
+	switch (curve)
+	{
+		case KeepFadeCurve::Linear:
+			envelope.p = 2.0; envelope.q = -1.0; envelope.c = 0.0;
+			break;
+		case KeepFadeCurve::Cosine:
+		{
+			double k = cos(M_PI * step);
+			envelope.p = 2.0 * k; envelope.q = -1.0; envelope.c = 1.0 - k;
+			break;
+		}
+		case KeepFadeCurve::Exponential:
 		{
-			double amplitude = m_amplitude;
+			double r = exp(step * log(1000.0));
+			envelope.p = r; envelope.q = 0.0; envelope.c = (r - 1.0) / (1000.0 - 1.0);
+			break;
+		}
+		default:
+			envelope.p = 2.0; envelope.q = -1.0; envelope.c = 2.0 * step * step;
+			break;
+	}
+
+	return envelope;
+}
+
+//
+// Apply the fade in fixed-point. The curve is evaluated every 64 frames, the gain is interpolated linearly between.
+static void ApplyFadeFixed(int32_t* samples, UINT32 frames, KeepFadeCurve curve, double position, double step)
+{
+	const UINT32 CHUNK_FRAMES = 64;
+	int32_t gain = int32_t(GetFadeVolume(curve, position) * Q30_ONE);
+
+	for (UINT32 chunk_start = 0; chunk_start < frames; chunk_start += CHUNK_FRAMES)
+	{
+		UINT32 chunk_frames = std::min(frames - chunk_start, CHUNK_FRAMES);
+		double end_position = std::clamp(position + step * (chunk_start + chunk_frames), 0.0, 1.0);
+		int32_t end_gain = int32_t(GetFadeVolume(curve, end_position) * Q30_ONE);
 
-			if (period_frames || m_curr_frame < fade_frames)
+		ApplyGainRampQ30(samples + chunk_start, chunk_frames, gain, (end_gain - gain) / int32_t(chunk_frames));
+		gain = end_gain;
+	}
+}
+
+//
+// Large buffers are written with streaming stores, so they don't evict data of other applications from the cache.
+// Smaller ones are written with regular stores, they fit in the cache of any modern CPU along with its other data.
+// The render-ahead ring is always written with regular stores, it's read back soon by the copy into the buffer.
+bool CSoundSession::IsStreaming(const BYTE* p_data, UINT32 frames) const
+{
+	const SIZE_T STREAMING_MIN_BYTES = 256 * 1024;
+
+	if (m_ahead_ring && p_data >= m_ahead_ring && p_data < m_ahead_ring + static_cast<SIZE_T>(m_frame_size) * m_ahead_frames)
+	{
+		return false;
+	}
+
+	return m_streaming_chains.steady && static_cast<SIZE_T>(m_frame_size) * frames >= STREAMING_MIN_BYTES;
+}
+
+//
+// Render a buffer of a generated signal, segment by segment.
+template <CSoundSession::Generator G>
+bool CSoundSession::RenderSignal(BYTE* p_data, UINT32 frames)
+{
+	bool is_streaming = this->IsStreaming(p_data, frames);
+
+	UINT32 segment_frames = 0;
+
+	for (UINT32 done_frames = 0; done_frames < frames; done_frames += segment_frames)
+	{
+		Segment segment = this->GetSegment(frames - done_frames, segment_frames);
+		this->RenderSegment<G>(p_data + static_cast<SIZE_T>(m_frame_size) * done_frames, segment_frames, segment, is_streaming);
+
+		m_curr_frame += segment_frames;
+		if (m_curr_frame == m_period_frames) { m_curr_frame = 0; }
+	}
+
+	if (is_streaming)
+	{
+		// Make streaming stores visible before the buffer is released to the audio engine.
+		StreamFence();
+	}
+
+	return true;
+}
+
+//
+// Split a segment into blocks, and render each one with its fade position and step. Steady blocks get position 1.
+// The fade position goes from 0 (silence) to 1 (full volume) during the fade, the curve maps it to volume.
+template <typename RenderBlock>
+void CSoundSession::RenderSegmentBlocks(BYTE* p_data, UINT32 frames, Segment segment, RenderBlock render_block)
+{
+	for (UINT32 block_start = 0; block_start < frames; block_start += SEGMENT_BLOCK_FRAMES)
+	{
+		UINT32 block_frames = std::min(frames - block_start, SEGMENT_BLOCK_FRAMES);
+		BYTE* p_block = p_data + static_cast<SIZE_T>(m_frame_size) * block_start;
+
+		double step = 0.0, position = 1.0;
+
+		if (segment != Segment::Steady)
+		{
+			uint64_t block_frame = m_curr_frame + block_start;
+			step = 1.0 / m_fade_frames;
+			position = (segment == Segment::FadeIn) ? step * block_frame : step * (m_play_frames - block_frame);
+			if (segment == Segment::FadeOut) { step = -step; }
+		}
+
+		render_block(p_block, block_frames, position, step);
+	}
+}
+
+//
+// Render frames of a single segment. The segment starts at the current frame, which is not advanced here.
+template <CSoundSession::Generator G>
+void CSoundSession::RenderSegment(BYTE* p_data, UINT32 frames, Segment segment, bool is_streaming)
+{
+	if (segment == Segment::Silence)
+	{
+		ZeroMemory(p_data, static_cast<SIZE_T>(m_frame_size) * frames);
+		return;
+	}
+
+	if constexpr (G == Generator::SineCached)
+	{
+		if (segment == Segment::Steady && !m_cycle_cache)
+		{
+			this->BuildCycleCache();
+		}
+
+		if (segment == Segment::Steady && m_cycle_cache)
+		{
+			const BlockChains& chains = is_streaming ? m_streaming_chains : m_chains;
+			BlockParams params = { {}, 1.0f, m_channels_count, m_frame_size };
+
+			for (UINT32 copy_frames; frames; frames -= copy_frames)
 			{
-				if (m_curr_frame < fade_frames)
-				{
-					// Fade in.
-					double fade_volume = (1.0 / fade_frames) * m_curr_frame;
-					amplitude *= pow(fade_volume, 2);
-				}
-				else if (!play_frames || m_curr_frame < (play_frames - fade_frames))
+				copy_frames = std::min(frames, m_cycle_frames - m_cycle_frame);
+				const BYTE* p_cycle = m_cycle_cache + static_cast<SIZE_T>(m_cycle_frame_size) * m_cycle_frame;
+				SIZE_T copy_size = static_cast<SIZE_T>(m_frame_size) * copy_frames;
+
+				if (m_cycle_frame_size != m_frame_size)
 				{
-					// Max volume.
+					chains.steady(p_data, p_cycle, copy_frames, params);
 				}
-				else if (m_curr_frame < play_frames)
+				else if (is_streaming)
 				{
-					// Fade out.
-					double fade_volume = (1.0 / fade_frames) * (play_frames - m_curr_frame);
-					amplitude *= pow(fade_volume, 2);
+					CopyStreaming(p_data, p_cycle, copy_size);
 				}
 				else
 				{
-					// Silence.
-					amplitude = 0;
+					memcpy(p_data, p_cycle, copy_size);
 				}
+
+				p_data += copy_size;
+				m_cycle_frame = (m_cycle_frame + copy_frames) % m_cycle_frames;
 			}
 
-			float sample = 0;
+			return;
+		}
+	}
+
+	if constexpr (IsMultichannel(G))
+	{
+		this->RenderSegmentLanes<G>(p_data, frames, segment);
+		return;
+	}
+
+	const BlockChains& chains = is_streaming ? m_streaming_chains : m_chains;
+	BlockParams params = { {}, 1.0f, m_channels_count, m_frame_size };
 
-			if (amplitude)
+	this->RenderSegmentBlocks(p_data, frames, segment, [&](BYTE* p_block, UINT32 block_frames, double position, double step)
+	{
+		if constexpr (IsFixedPoint(G))
+		{
+			alignas(16) int32_t samples[SEGMENT_BLOCK_FRAMES];
+			this->GenerateBlockFixed<G>(samples, block_frames);
+			if (segment != Segment::Steady) { ApplyFadeFixed(samples, block_frames, m_fade_curve, position, step); }
+			params.gain = float(m_amplitude) / Q30_ONE;
+			chains.fixed(p_block, samples, block_frames, params);
+		}
+		else
+		{
+			alignas(16) float block[SEGMENT_BLOCK_FRAMES];
+			this->GenerateBlock<G>(block, block_frames);
+
+			if (segment == Segment::Steady)
 			{
-				sample = float(sin(m_curr_theta) * amplitude);
-				m_curr_theta += theta_increment;
+				chains.steady(p_block, block, block_frames, params);
 			}
-
-			for (size_t j = 0; j < m_channels_count; j++)
+			else
 			{
-				*reinterpret_cast<float*>(p_data + j * sizeof(float)) = sample;
+				params.envelope = MakeFadeEnvelope(m_fade_curve, position, step);
+				chains.fade(p_block, block, block_frames, params);
 			}
-
-			p_data += m_frame_size;
-			m_curr_frame++;
-			if (period_frames) { m_curr_frame %= period_frames; }
 		}
+	});
+}
+
+//
+// Generate mono samples of a block and advance the generator state.
+template <CSoundSession::Generator G>
+void CSoundSession::GenerateBlock(float* block, UINT32 frames)
+{
+	if constexpr (G == Generator::Sine)
+	{
+		m_kernels.generate_sine(block, frames, m_curr_phase, m_phase_increment, float(m_amplitude));
+		m_curr_phase += m_phase_increment * frames;
 	}
-	else if ((m_stream_type == KeepStreamType::WhiteNoise || m_stream_type == KeepStreamType::BrownNoise || m_stream_type == KeepStreamType::PinkNoise) && m_amplitude)
+	else if constexpr (G == Generator::SineCached)
 	{
-		uint64_t lcg_state = GetTickCount64();
+		// The phase is derived from the position in the cycle, so generated frames match the cached ones.
+		uint32_t phase = uint32_t((uint64_t(m_cycle_frame) << 32) / m_cycle_frames);
+		m_kernels.generate_sine(block, frames, phase, m_phase_increment, float(m_amplitude));
+		m_cycle_frame = (m_cycle_frame + frames) % m_cycle_frames;
+	}
+	else if constexpr (G == Generator::SineTable)
+	{
+		GenerateSineFromTable(block, frames, m_curr_phase, m_phase_increment, float(m_amplitude));
+		m_curr_phase += m_phase_increment * frames;
+	}
+	else if constexpr (G == Generator::WhiteNoise)
+	{
+		m_kernels.generate_uniform(block, frames, m_noise_counter, m_noise_seed, float(m_amplitude));
+		m_noise_counter += frames;
+	}
+	else if constexpr (G == Generator::BrownNoise)
+	{
+		m_kernels.generate_uniform(block, frames, m_noise_counter, m_noise_seed, 1.0f);
+		m_noise_counter += frames;
+		FilterBrownNoise(block, frames, m_curr_value, m_brown_filter, float(m_amplitude));
+	}
+	else if constexpr (G == Generator::PinkNoise)
+	{
+		m_kernels.generate_uniform(block, frames, m_noise_counter, m_noise_seed, 1.0f);
+		m_noise_counter += frames;
+		FilterPinkNoise(block, frames, m_curr_state, m_pink_filter, float(m_amplitude));
+	}
+	else if constexpr (G == Generator::PinkNoiseFloat)
+	{
+		m_kernels.generate_uniform(block, frames, m_noise_counter, m_noise_seed, 1.0f);
+		m_noise_counter += frames;
+		FilterPinkNoiseFloat(block, frames, m_curr_poles, m_pink_filter, float(m_amplitude));
+	}
+	else if constexpr (G == Generator::PinkNoiseVoss)
+	{
+		GeneratePinkNoiseVoss(block, frames, m_noise_counter, m_noise_seed, m_curr_rows, m_pink_rows, float(m_amplitude));
+		m_noise_counter += frames;
+	}
+	else if constexpr (G == Generator::SubsonicNoise)
+	{
+		GenerateSubsonicNoise(block, frames, m_noise_seed, m_curr_subsonic, m_subsonic_filter, float(m_amplitude));
+	}
+	else if constexpr (G == Generator::ShapedNoise)
+	{
+		// The counter is advanced a pair of FFT blocks at a time.
+		GenerateShapedNoise(block, frames, m_noise_counter, m_noise_seed, m_shaped_noise, float(m_amplitude), m_kernels.generate_uniform);
+	}
+}
 
-		for (size_t i = 0; i < need_frames; i++)
+//
+// Render frames of a single segment of multichannel noise. Same as RenderSegment(), but each group of channels that fits
+// in a vector of the lane kernels is generated and faded separately.
+template <CSoundSession::Generator G>
+void CSoundSession::RenderSegmentLanes(BYTE* p_data, UINT32 frames, Segment segment)
+{
+	size_t channels = std::min<size_t>(m_channels_count, NOISE_LANE_CHANNELS);
+	BlockParams params = { {}, 1.0f, m_channels_count, m_frame_size };
+
+	this->RenderSegmentBlocks(p_data, frames, segment, [&](BYTE* p_block, UINT32 block_frames, double position, double step)
+	{
+		alignas(32) float lanes[SEGMENT_BLOCK_FRAMES * NOISE_LANE_CHANNELS];
+
+		for (size_t first_channel = 0; first_channel < channels; first_channel += m_kernels.lanes.width)
 		{
-			double amplitude = m_amplitude;
+			this->GenerateBlockLanes<G>(lanes, block_frames, first_channel);
 
-			if (period_frames || m_curr_frame < fade_frames)
+			if (segment == Segment::Steady)
 			{
-				if (m_curr_frame < fade_frames)
-				{
-					// Fade in.
-					double fade_volume = (1.0 / fade_frames) * m_curr_frame;
-					amplitude *= pow(fade_volume, 2);
-				}
-				else if (!play_frames || m_curr_frame < (play_frames - fade_frames))
-				{
-					// Max volume.
-				}
-				else if (m_curr_frame < play_frames)
-				{
-					// Fade out.
-					double fade_volume = (1.0 / fade_frames) * (play_frames - m_curr_frame);
-					amplitude *= pow(fade_volume, 2);
-				}
-				else
-				{
-					// Silence.
-					amplitude = 0;
-				}
+				m_kernels.lanes.fan_out(p_block, lanes, block_frames, first_channel, params);
 			}
+			else
+			{
+				params.envelope = MakeFadeEnvelope(m_fade_curve, position, step);
+				m_kernels.lanes.fan_out_fade(p_block, lanes, block_frames, first_channel, params);
+			}
+		}
 
-			float sample = 0;
+		m_noise_counter += block_frames;
+	});
+}
 
-			if (amplitude)
-			{
-				lcg_state = lcg_state * 6364136223846793005ULL + 1; // LCG from Musl.
-				double value = (double((lcg_state >> 32) & 0x7FFFFFFF) / double(0x7FFFFFFFU)) * 2.0 - 1.0; // -1 .. 1
+//
+// Generate a vector of channels of a block starting from the given one. The noise counter is advanced by the caller.
+template <CSoundSession::Generator G>
+void CSoundSession::GenerateBlockLanes(float* lanes, UINT32 frames, size_t first_channel)
+{
+	const NoiseLaneKernels& kernels = m_kernels.lanes;
 
-				if (m_stream_type == KeepStreamType::BrownNoise)
+	if constexpr (G == Generator::WhiteNoiseLanes)
+	{
+		kernels.generate_uniform(lanes, frames, m_noise_counter, m_noise_seed, first_channel, float(m_amplitude));
+	}
+	else if constexpr (G == Generator::BrownNoiseLanes)
+	{
+		kernels.generate_uniform(lanes, frames, m_noise_counter, m_noise_seed, first_channel, 1.0f);
+		kernels.filter_brown(lanes, frames, m_curr_lanes, first_channel, m_brown_filter, float(m_amplitude));
+	}
+	else if constexpr (G == Generator::PinkNoiseLanes)
+	{
+		kernels.generate_uniform(lanes, frames, m_noise_counter, m_noise_seed, first_channel, 1.0f);
+		kernels.filter_pink(lanes, frames, m_curr_lanes, first_channel, m_pink_filter, float(m_amplitude));
+	}
+	else if constexpr (G == Generator::PinkNoiseVossLanes)
+	{
+		kernels.generate_pink_voss(lanes, frames, m_noise_counter, m_noise_seed, first_channel, m_curr_lanes, m_pink_rows, float(m_amplitude));
+	}
+}
+
+//
+// Generate mono Q30 samples of a block at full amplitude and advance the generator state.
+template <CSoundSession::Generator G>
+void CSoundSession::GenerateBlockFixed(int32_t* block, UINT32 frames)
+{
+	if constexpr (G == Generator::SineFixed)
+	{
+		GenerateSineQ30(block, frames, m_curr_phase, m_phase_increment);
+		m_curr_phase += m_phase_increment * frames;
+	}
+	else if constexpr (G == Generator::WhiteNoiseFixed)
+	{
+		GenerateUniformQ30(block, frames, m_noise_counter, m_noise_seed);
+		m_noise_counter += frames;
+	}
+	else if constexpr (G == Generator::BrownNoiseFixed)
+	{
+		GenerateUniformQ30(block, frames, m_noise_counter, m_noise_seed);
+		m_noise_counter += frames;
+		FilterBrownNoiseQ30(block, frames, m_curr_level, m_brown_filter);
+	}
+	else if constexpr (G == Generator::PinkNoiseFixed)
+	{
+		GeneratePinkNoiseVossQ30(block, frames, m_noise_counter, m_noise_seed, m_curr_rows, m_pink_rows);
+		m_noise_counter += frames;
+	}
+}
+
+//
+// Render one sine cycle into the cache. Falls back to the regular sine generator if there is not enough memory.
+void CSoundSession::BuildCycleCache()
+{
+	m_cycle_cache = new BYTE[static_cast<SIZE_T>(m_cycle_frame_size) * m_cycle_frames]();
+	if (!m_cycle_cache)
+	{
+		DebugLogWarning("Unable to allocate sine cycle cache.");
+		m_curr_phase = uint32_t((uint64_t(m_cycle_frame) << 32) / m_cycle_frames);
+		m_render_frames = &CSoundSession::RenderSignal<Generator::Sine>;
+		return;
+	}
+
+	const UINT32 BLOCK_FRAMES = 256;
+	alignas(16) float block[BLOCK_FRAMES];
+	BlockParams params = { {}, 1.0f, m_channels_count, m_frame_size };
+	UINT32 curr_frame = m_cycle_frame;
+	m_cycle_frame = 0;
+
+	for (UINT32 block_start = 0; block_start < m_cycle_frames; block_start += BLOCK_FRAMES)
+	{
+		UINT32 block_frames = std::min(m_cycle_frames - block_start, BLOCK_FRAMES);
+		BYTE* p_cycle = m_cycle_cache + static_cast<SIZE_T>(m_cycle_frame_size) * block_start;
+
+		// The kernels write whole vectors, so even mono samples are generated into the block and copied.
+		this->GenerateBlock<Generator::SineCached>(block, block_frames);
+
+		if (m_cycle_frame_size != m_frame_size)
+		{
+			memcpy(p_cycle, block, static_cast<SIZE_T>(block_frames) * sizeof(float));
+		}
+		else
+		{
+			m_chains.steady(p_cycle, block, block_frames, params);
+		}
+	}
+
+	m_cycle_frame = curr_frame;
+	DebugLog("Sine cycle is cached%s: %u frames, %u bytes.", (m_cycle_frame_size != m_frame_size) ? " as mono samples" : "",
+		m_cycle_frames, m_cycle_frames * m_cycle_frame_size);
+}
+
+//
+// Render the Fluctuate stream. It's zeroes with rare impulses, so only the impulse frames are written.
+// Returns false when no impulse falls into the buffer. The buffer isn't touched then, it should be released as silent.
+bool CSoundSession::RenderImpulses(BYTE* p_data, UINT32 frames)
+{
+	// 0x38000100 = 3.051851E-5 = 1.0/32767. Minimal 16-bit deviation from 0.
+	// 0x34000001 = 1.192093E-7 = 1.0/8388607. Minimal 24-bit deviation from 0.
+	const uint32_t impulse = (m_out_sample_type == SampleType::Int16) ? 0x38000100 : 0x34000001;
+
+	bool is_zeroed = false;
+	UINT32 segment_frames = 0;
+
+	for (UINT32 done_frames = 0; done_frames < frames; done_frames += segment_frames)
+	{
+		// Fluctuate is not faded, so fading segments are played as is.
+		if (this->GetSegment(frames - done_frames, segment_frames) != Segment::Silence)
+		{
+			// Impulses are at multiples of m_once_in_frames.
+			uint64_t impulse_frame = (m_curr_frame + m_once_in_frames - 1) / m_once_in_frames * m_once_in_frames;
+
+			for (; impulse_frame < m_curr_frame + segment_frames; impulse_frame += m_once_in_frames)
+			{
+				if (!is_zeroed)
 				{
-					// Brown Noise from SoX + a leaky integrator to reduce low frequency humming.
-					m_curr_value += value * (1.0 / 16);
-					m_curr_value /= 1.02; // The leaky integrator.
-					m_curr_value = fmod(m_curr_value, 4);
-					value = m_curr_value;
-
-					// Normalize values out of the -1..1 range using "mirroring".
-					// Example: 0.8, 0.9, 1.0, 0.9, 0.8, ..., -0.8, -0.9, -1.0, -0.9, -0.8, ...
-					// Precondition: value must be between -4.0 and 4.0.
-					if (value < -1.0 || 1.0 < value)
-					{
-						double sign = (value < 0.0) ? -1.0 : 1.0;
-						value = fabs(value);
-						value = ((value <= 3.0) ? (2.0 - value) : (value - 4.0)) * sign;
-					}
+					ZeroMemory(p_data, static_cast<SIZE_T>(m_frame_size) * frames);
+					is_zeroed = true;
 				}
-				else if (m_stream_type == KeepStreamType::PinkNoise)
+
+				// Negate each odd time.
+				uint32_t sample = impulse;
+				if ((impulse_frame / m_once_in_frames) & 1)
 				{
-					// Paul Kellet's method.
-					double white = value;
-					m_curr_state[0] = 0.99886 * m_curr_state[0] + white * 0.0555179;
-					m_curr_state[1] = 0.99332 * m_curr_state[1] + white * 0.0750759;
-					m_curr_state[2] = 0.96900 * m_curr_state[2] + white * 0.1538520;
-					m_curr_state[3] = 0.86650 * m_curr_state[3] + white * 0.3104856;
-					m_curr_state[4] = 0.55000 * m_curr_state[4] + white * 0.5329522;
-					m_curr_state[5] = -0.7616 * m_curr_state[5] - white * 0.0168980;
-					value = m_curr_state[0] + m_curr_state[1] + m_curr_state[2] + m_curr_state[3] + m_curr_state[4] + m_curr_state[5] + m_curr_state[6] + white * 0.5362;
-					value *= 0.11; // (roughly) compensate for gain.
-					m_curr_state[6] = white * 0.115926;
+					sample |= 0x80000000;
 				}
 
-				sample = float(value * amplitude);
-			}
-
-			for (size_t j = 0; j < m_channels_count; j++)
-			{
-				*reinterpret_cast<float*>(p_data + j * sizeof(float)) = sample;
+				BYTE* p_frame = p_data + static_cast<SIZE_T>(m_frame_size) * (done_frames + (impulse_frame - m_curr_frame));
+				for (size_t j = 0; j < m_channels_count; j++)
+				{
+					*reinterpret_cast<uint32_t*>(p_frame + j * sizeof(float)) = sample;
+				}
 			}
-
-			p_data += m_frame_size;
-			m_curr_frame++;
-			if (period_frames) { m_curr_frame %= period_frames; }
 		}
-	}
-	else
-	{
-		// ZeroMemory(p_data, static_cast<SIZE_T>(m_frame_size) * need_frames);
-		render_flags = AUDCLNT_BUFFERFLAGS_SILENT;
-	}
 
-	hr = m_render_client->ReleaseBuffer(need_frames, render_flags);
-	if (FAILED(hr))
-	{
-		DebugLogError("Failed to release buffer: 0x%08X.", hr);
-		return hr;
+		m_curr_frame += segment_frames;
+		if (m_curr_frame == m_period_frames) { m_curr_frame = 0; }
 	}
 
-	return S_OK;
+	return is_zeroed;
 }
 
 CSoundSession::RenderingMode CSoundSession::WaitExclusive()
@@ -916,23 +1821,11 @@ CSoundSession::RenderingMode CSoundSession::WaitExclusive()
 			return exit_mode;
 		}
 
-		// Wait until we receive a notification that the streem is inactive.
-		switch (WaitForOne(m_interrupt))
-		{
-		case WAIT_OBJECT_0: // m_interrupt.
-
-			// We're done, exit the loop.
-			exit_mode = m_next_mode;
-			break;
-
-		default:
-
-			// Should never happen.
-			exit_mode = RenderingMode::Invalid;
-			break;
-		}
-
-		session_control->UnregisterAudioSessionNotification(this);
+		// Wait until we receive a notification that the streem is inactive. The session is kept until then,
+		// and Service() unregisters it when the mode is changed.
+		m_exclusive_session = session_control;
+		session_control = nullptr;
+		exit_mode = RenderingMode::WaitExclusive;
 	}
 
 	return exit_mode;
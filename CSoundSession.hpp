@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Common.hpp"
+#include "SoundGenerators.hpp"
 
 #include <mmdeviceapi.h>
 #include <audioclient.h>
@@ -16,10 +17,27 @@ class CSoundSession : IAudioSessionEvents
 protected:
 
 	static bool g_is_leaky_wasapi;
+	static bool g_use_scalar_kernels;
+	static bool g_use_fixed_point;
+	static bool g_use_min_format;
+	static bool g_use_render_ahead;
+	static uint32_t g_noise_seed;
+
+	// One rendering thread drives all sessions, each one is serviced when its deadline comes or it's interrupted.
+	static CriticalSection g_scheduler_mutex;
+	static HANDLE g_scheduler_thread;
+	static bool g_is_scheduler_running;
+	static AutoResetEvent g_scheduler_wakeup;
+	static CSoundSession* g_scheduled_sessions;
 
 public:
 
 	static void EnableWaitExclusiveWorkaround(bool enable) { g_is_leaky_wasapi = enable; }
+	static void EnableScalarKernels(bool enable) { g_use_scalar_kernels = enable; }
+	static void EnableFixedPoint(bool enable) { g_use_fixed_point = enable; }
+	static void EnableMinimalFormat(bool enable) { g_use_min_format = enable; }
+	static void EnableRenderAhead(bool enable) { g_use_render_ahead = enable; }
+	static void SetNoiseSeed(uint32_t seed) { g_noise_seed = seed; }
 
 protected:
 
@@ -31,8 +49,27 @@ protected:
 	LPWSTR                  m_device_id = nullptr;
 	KeepStreamType          m_stream_type = KeepStreamType::Zero;
 
-	HANDLE                  m_render_thread = NULL;
+	// Started sessions are linked into the list of the rendering thread. It signals m_is_started when it has serviced
+	// a session for the first time, and m_is_stopped when one leaves the list.
+	bool                    m_is_scheduled = false;
+	bool                    m_is_starting = false;
+	CSoundSession*          m_next_session = nullptr;
 	ManualResetEvent        m_is_started = false;
+	ManualResetEvent        m_is_stopped = false;
+
+	// Tick count when the session needs the rendering thread next. The slack is how much earlier it can be serviced,
+	// so the thread can service several sessions in one wakeup.
+	static const ULONGLONG  INFINITE_DEADLINE = ~0ULL;
+	ULONGLONG               m_deadline = 0;
+	DWORD                   m_deadline_slack = 0;
+
+	void SetDeadline(DWORD delay, DWORD slack = 0)
+	{
+		m_deadline = delay == INFINITE ? INFINITE_DEADLINE : GetTickCount64() + delay;
+		m_deadline_slack = slack;
+	}
+
+	void SetRenderDeadline();
 
 	enum class RenderingMode { Stop, Rendering, Retry, WaitExclusive, TryOpenDevice, Invalid };
 	RenderingMode           m_curr_mode = RenderingMode::Stop;
@@ -45,11 +82,24 @@ protected:
 	{
 		m_next_mode = next_mode;
 		m_interrupt = true;
+		g_scheduler_wakeup = true;
 	}
 
+	// Render-ahead mode: a low priority thread renders frames to a ring, and the rendering thread only copies them.
+	// Only the producer thread advances the write counter, and only the rendering thread advances the read counter.
+	// Counters are in frames and wrap around, the size of the ring is a power of 2.
+	HANDLE                  m_ahead_thread = NULL;
+	AutoResetEvent          m_ahead_wakeup = false;
+	ManualResetEvent        m_ahead_stop = false;
+	BYTE*                   m_ahead_ring = nullptr;
+	UINT32                  m_ahead_frames = 0;
+	atomic_uint32_t         m_ahead_read = 0;
+	atomic_uint32_t         m_ahead_write = 0;
+
 	IAudioClient*           m_audio_client = nullptr;
 	IAudioRenderClient*     m_render_client = nullptr;
 	IAudioSessionControl*   m_audio_session_control = nullptr;
+	IAudioSessionControl*   m_exclusive_session = nullptr; // The exclusive mode session that is waited for.
 
 	enum class SampleType { Unknown, Int16, Int24, Int32, Float32 };
 	static SampleType ParseSampleType(WAVEFORMATEX* format);
@@ -60,26 +110,99 @@ protected:
 	UINT32                  m_channels_count = 0;
 	UINT32                  m_frame_size = 0;
 
+	// Kernels for the instruction sets of the CPU. Selected once, when the session is created.
+	GeneratorKernels        m_kernels = {};
+
+	// Stages after the source that write mono blocks to all channels. Selected for the format when rendering is started.
+	BlockChains             m_chains = {};
+	BlockChains             m_streaming_chains = {}; // For large buffers, null if the format has none.
+
 	UINT32                  m_buffer_size_in_ms = 1000;
 	UINT32                  m_buffer_size_in_frames = 0;
+	UINT32                  m_filled_frames = 0; // Buffered frames after the last Render(), the next wakeup is planned from it.
 
 	// Sound generation settings.
 	double                  m_frequency = 0.0;
 	double                  m_amplitude = 0.0;
 
+	bool                    m_pink_noise_voss = false;
+	bool                    m_decorrelated_noise = false;
+
 	// Periodicity settings.
 	double                  m_play_seconds = 0.0;
 	double                  m_wait_seconds = 0.0;
 	double                  m_fade_seconds = 0.0;
+	KeepFadeCurve           m_fade_curve = KeepFadeCurve::Quadratic;
+
+	// Periodicity schedule in frames. Calculated by PrepareRendering() when the sample rate is known.
+	uint64_t                m_play_frames = 0;
+	uint64_t                m_wait_frames = 0;
+	uint64_t                m_fade_frames = 0;
+	uint64_t                m_period_frames = 0;
+
+	// Each buffer is split into contiguous segments, so the generators don't check the schedule per frame.
+	enum class Segment { FadeIn, Steady, FadeOut, Silence };
+	Segment GetSegment(UINT32 max_frames, UINT32& frames) const;
+
+	// Renders a buffer of the stream, returns false if the buffer is silent. It's selected by PrepareRendering(),
+	// so the stream type and the generator are not checked per buffer. Null if the stream is inaudible.
+	// Multichannel generators render each channel separately, a vector of channels at once (see NoiseLaneKernels).
+	// Fixed-point generators go last, they produce Q30 integers that are converted to floats only at the end.
+	enum class Generator
+	{
+		Sine, SineCached, SineTable, WhiteNoise, BrownNoise, PinkNoise, PinkNoiseFloat, PinkNoiseVoss, SubsonicNoise, ShapedNoise,
+		WhiteNoiseLanes, BrownNoiseLanes, PinkNoiseLanes, PinkNoiseVossLanes,
+		SineFixed, WhiteNoiseFixed, BrownNoiseFixed, PinkNoiseFixed,
+	};
+	static constexpr bool IsMultichannel(Generator generator) { return generator >= Generator::WhiteNoiseLanes && generator < Generator::SineFixed; }
+	static constexpr bool IsFixedPoint(Generator generator) { return generator >= Generator::SineFixed; }
+	bool                    (CSoundSession::*m_render_frames)(BYTE* p_data, UINT32 frames) = nullptr;
+
+	// Sound generation parameters derived from the settings.
+	uint32_t                m_phase_increment = 0;
+	uint64_t                m_once_in_frames = 0;
+	PinkNoiseFilter         m_pink_filter = {};
+	BrownNoiseFilter        m_brown_filter = {};
+	uint32_t                m_pink_rows = 0;
+	SubsonicFilter          m_subsonic_filter = {};
+
+	// Shaped noise filter and its FFT buffers, allocated for the shaped noise stream only.
+	ShapedNoise             m_shaped_noise = {};
+	float*                  m_shaped_memory = nullptr;
+
+	// Noise generator state. Each session has its own seed, the counter is the index of the next sample.
+	uint32_t                m_noise_seed = 0;
+	uint32_t                m_noise_counter = 0;
+
+	// Output frames of one sine cycle when it's a whole number of frames. Steady parts are copied from it.
+	// Long cycles of wide formats are kept as mono float samples, they are converted to output frames per buffer.
+	// It's built lazily on the rendering thread, and dropped when the settings or the format change.
+	BYTE*                   m_cycle_cache = nullptr;
+	UINT32                  m_cycle_frames = 0;
+	UINT32                  m_cycle_frame_size = 0;
+	UINT32                  m_cycle_frame = 0;
+
+	void BuildCycleCache();
+
+	void DropCycleCache()
+	{
+		delete[] m_cycle_cache;
+		m_cycle_cache = nullptr;
+	}
 
 	// Current state.
 	uint64_t                m_curr_frame = 0;
 	union
 	{
-		double              m_curr_state[8]{0}; // Pink Noise.
+		double              m_curr_state[8];    // Pink Noise.
+		SubsonicState       m_curr_subsonic;    // Subsonic Noise.
+		float               m_curr_poles[9];    // Pink Noise (single precision).
+		int32_t             m_curr_rows[PINK_NOISE_MAX_ROWS + 1]{0}; // Pink Noise (Voss-McCartney): rows and their sum.
 		double              m_curr_value;       // Brown Noise.
-		double              m_curr_theta;       // Sine.
+		int32_t             m_curr_level;       // Brown Noise (fixed-point).
+		uint32_t            m_curr_phase;       // Sine.
 	};
+	NoiseLanesState         m_curr_lanes{};     // Multichannel Noise.
 
 public:
 
@@ -96,8 +219,12 @@ public:
 		if (m_curr_frame)
 		{
 			m_curr_frame = 0;
-			memset(m_curr_state, 0, sizeof(m_curr_state));
+			memset(m_curr_rows, 0, sizeof(m_curr_rows)); // The largest member.
+			memset(&m_curr_lanes, 0, sizeof(m_curr_lanes));
 		}
+
+		m_cycle_frame = 0;
+		this->DropCycleCache();
 	}
 
 	void SetStreamType(KeepStreamType stream_type)
@@ -135,6 +262,30 @@ public:
 		return m_amplitude;
 	}
 
+	// Noise generation settings.
+
+	void SetPinkNoiseVoss(bool enable)
+	{
+		m_pink_noise_voss = enable;
+		this->ResetCurrent();
+	}
+
+	bool GetPinkNoiseVoss() const
+	{
+		return m_pink_noise_voss;
+	}
+
+	void SetDecorrelatedNoise(bool enable)
+	{
+		m_decorrelated_noise = enable;
+		this->ResetCurrent();
+	}
+
+	bool GetDecorrelatedNoise() const
+	{
+		return m_decorrelated_noise;
+	}
+
 	// Periodicity settings.
 
 	void SetPeriodicPlaying(double seconds)
@@ -170,6 +321,17 @@ public:
 		return m_fade_seconds;
 	}
 
+	void SetFadeCurve(KeepFadeCurve curve)
+	{
+		m_fade_curve = curve;
+		this->ResetCurrent();
+	}
+
+	KeepFadeCurve GetFadeCurve() const
+	{
+		return m_fade_curve;
+	}
+
 protected:
 
 	~CSoundSession(void);
@@ -178,11 +340,31 @@ protected:
 	// Rendering thread.
 	//
 
-	static DWORD APIENTRY RenderingThreadEntry(LPVOID context);
-	DWORD RenderingThread();
+	static DWORD APIENTRY SchedulerThreadEntry(LPVOID context);
+	static DWORD SchedulerThread();
+	enum class ServiceResult { Waiting, Serviced, Finished };
+	ServiceResult Service(ULONGLONG due_time);
 	RenderingMode TryOpenDevice();
-	RenderingMode Rendering();
+	RenderingMode StartRendering();
+	void StopRendering();
+	void PrepareRendering();
 	HRESULT Render();
+	DWORD GetRenderTimeout() const;
+	bool StartRenderAhead();
+	void StopRenderAhead();
+	static DWORD APIENTRY RenderAheadThreadEntry(LPVOID context);
+	void RenderAhead();
+	void ReadAhead(BYTE* p_data, UINT32 frames);
+	bool IsStreaming(const BYTE* p_data, UINT32 frames) const;
+	bool RenderImpulses(BYTE* p_data, UINT32 frames);
+	template <Generator G> bool RenderSignal(BYTE* p_data, UINT32 frames);
+	static constexpr UINT32 SEGMENT_BLOCK_FRAMES = 256;
+	template <Generator G> void RenderSegment(BYTE* p_data, UINT32 frames, Segment segment, bool is_streaming);
+	template <Generator G> void RenderSegmentLanes(BYTE* p_data, UINT32 frames, Segment segment);
+	template <typename RenderBlock> void RenderSegmentBlocks(BYTE* p_data, UINT32 frames, Segment segment, RenderBlock render_block);
+	template <Generator G> void GenerateBlock(float* block, UINT32 frames);
+	template <Generator G> void GenerateBlockFixed(int32_t* block, UINT32 frames);
+	template <Generator G> void GenerateBlockLanes(float* lanes, UINT32 frames, size_t first_channel);
 	RenderingMode WaitExclusive();
 
 public:
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "BasicDefines.hpp"
+#include "NtBase.hpp"
+
+#if IS_X86
+	#include <intrin.h>
+#endif
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+// Instruction sets of the CPU that the OS also supports (AVX state must be saved by the OS on context switches).
+// Release builds target the baseline of each architecture, so anything newer is checked here at runtime.
+
+struct CpuFeatures
+{
+	bool sse2;
+	bool sse41;
+	bool avx2;
+	bool avx512;
+	bool neon;
+};
+
+// Detection runs CPUID, so it's done once at startup and the result is passed down (see CSoundKeeper).
+
+inline CpuFeatures DetectCpuFeatures()
+{
+	CpuFeatures features = {};
+
+#if IS_X86
+	int info[4] = {};
+	__cpuid(info, 0);
+	int max_leaf = info[0];
+
+	__cpuid(info, 1);
+	features.sse2 = (info[3] >> 26) & 1;
+	features.sse41 = (info[2] >> 19) & 1;
+	bool has_osxsave = (info[2] >> 27) & 1;
+	bool has_avx = (info[2] >> 28) & 1;
+
+	// XCR0 bits: 1 is SSE state, 2 is AVX state, 5-7 are AVX-512 opmask and ZMM states.
+	uint64_t xcr0 = has_osxsave ? _xgetbv(0) : 0;
+	bool is_avx_enabled = has_avx && (xcr0 & 0x06) == 0x06;
+	bool is_avx512_enabled = is_avx_enabled && (xcr0 & 0xE0) == 0xE0;
+
+	if (max_leaf >= 7)
+	{
+		__cpuidex(info, 7, 0);
+		features.avx2 = is_avx_enabled && ((info[1] >> 5) & 1);
+		features.avx512 = is_avx512_enabled && ((info[1] >> 16) & 1);
+	}
+#elif IS_ARM64
+	// NEON is the baseline of ARM64, but ask anyway, so the log tells what the OS reports.
+	features.neon = IsProcessorFeaturePresent(PF_ARM_NEON_INSTRUCTIONS_AVAILABLE);
+#endif
+
+	return features;
+}
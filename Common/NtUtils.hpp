@@ -93,6 +93,32 @@ inline HRESULT WINAPI GetThreadDescriptionW(_In_ HANDLE hThread, _Outptr_result_
 
 // ---------------------------------------------------------------------------------------------------------------------
 
+// EcoQoS: Windows runs the thread on efficiency cores at a lower clock. Works on Windows 10 1709+ and is ignored before.
+
+inline BOOL SetCurrentThreadEcoQoS(bool enable)
+{
+	static void* pfn = nullptr;
+
+	if (!pfn)
+	{
+		if (HMODULE dll = GetKernelBaseDll())
+		{
+			pfn = GetProcAddress(dll, "SetThreadInformation");
+		}
+	}
+
+	if (!pfn) { return FALSE; }
+
+	THREAD_POWER_THROTTLING_STATE state = {};
+	state.Version = THREAD_POWER_THROTTLING_CURRENT_VERSION;
+	state.ControlMask = THREAD_POWER_THROTTLING_EXECUTION_SPEED;
+	state.StateMask = enable ? THREAD_POWER_THROTTLING_EXECUTION_SPEED : 0;
+
+	return static_cast<decltype(SetThreadInformation)*>(pfn)(GetCurrentThread(), ThreadPowerThrottling, &state, sizeof(state));
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
 struct RsrcSpan
 {
 	const uint8_t* data;
@@ -0,0 +1,291 @@
+#pragma once
+
+#include "BasicDefines.hpp"
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+// Minimal portable 4-lane vector types. SSE2 is the baseline of x86-64, and NEON is the baseline of ARM64.
+// Other targets (x86-32 is built without SSE) use a plain scalar implementation with the same interface.
+
+#if IS_X8664
+	#include <emmintrin.h>
+	#define IS_SIMD_SSE2    1
+	#define IS_SIMD_NEON    0
+#elif IS_ARM64
+	#include <arm_neon.h>
+	#define IS_SIMD_SSE2    0
+	#define IS_SIMD_NEON    1
+#else
+	#define IS_SIMD_SSE2    0
+	#define IS_SIMD_NEON    0
+#endif
+
+#define IS_SIMD (IS_SIMD_SSE2 || IS_SIMD_NEON)
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+// 32-bit integer lanes. Arithmetic wraps around like unsigned arithmetic does, shifts are logical.
+
+struct Int4
+{
+	static constexpr size_t Width = 4;
+
+#if IS_SIMD_SSE2
+	__m128i v;
+	static FORCEINLINE Int4 Make(__m128i v) { Int4 r; r.v = v; return r; }
+	static FORCEINLINE Int4 Set(uint32_t x) { return Make(_mm_set1_epi32(int(x))); }
+	static FORCEINLINE Int4 Set(uint32_t a, uint32_t b, uint32_t c, uint32_t d) { return Make(_mm_setr_epi32(int(a), int(b), int(c), int(d))); }
+	static FORCEINLINE Int4 Load(const int32_t* p) { return Make(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))); }
+	FORCEINLINE void Store(int32_t* p) const { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+	friend FORCEINLINE Int4 operator+(Int4 a, Int4 b) { return Make(_mm_add_epi32(a.v, b.v)); }
+	friend FORCEINLINE Int4 operator-(Int4 a, Int4 b) { return Make(_mm_sub_epi32(a.v, b.v)); }
+	friend FORCEINLINE Int4 operator&(Int4 a, Int4 b) { return Make(_mm_and_si128(a.v, b.v)); }
+	friend FORCEINLINE Int4 operator^(Int4 a, Int4 b) { return Make(_mm_xor_si128(a.v, b.v)); }
+	friend FORCEINLINE Int4 operator>>(Int4 a, int n) { return Make(_mm_srl_epi32(a.v, _mm_cvtsi32_si128(n))); }
+	friend FORCEINLINE Int4 operator<<(Int4 a, int n) { return Make(_mm_sll_epi32(a.v, _mm_cvtsi32_si128(n))); }
+	friend FORCEINLINE Int4 operator*(Int4 a, Int4 b)
+	{
+		// SSE2 has no 32-bit multiplication, so multiply even and odd lanes to 64 bits and take the low halves.
+		__m128i even = _mm_mul_epu32(a.v, b.v);
+		__m128i odd = _mm_mul_epu32(_mm_srli_epi64(a.v, 32), _mm_srli_epi64(b.v, 32));
+		return Make(_mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0))));
+	}
+#elif IS_SIMD_NEON
+	int32x4_t v;
+	static FORCEINLINE Int4 Make(int32x4_t v) { Int4 r; r.v = v; return r; }
+	static FORCEINLINE Int4 Set(uint32_t x) { return Make(vdupq_n_s32(int32_t(x))); }
+	static FORCEINLINE Int4 Set(uint32_t a, uint32_t b, uint32_t c, uint32_t d) { const int32_t t[4] = { int32_t(a), int32_t(b), int32_t(c), int32_t(d) }; return Make(vld1q_s32(t)); }
+	static FORCEINLINE Int4 Load(const int32_t* p) { return Make(vld1q_s32(p)); }
+	FORCEINLINE void Store(int32_t* p) const { vst1q_s32(p, v); }
+	friend FORCEINLINE Int4 operator+(Int4 a, Int4 b) { return Make(vaddq_s32(a.v, b.v)); }
+	friend FORCEINLINE Int4 operator-(Int4 a, Int4 b) { return Make(vsubq_s32(a.v, b.v)); }
+	friend FORCEINLINE Int4 operator&(Int4 a, Int4 b) { return Make(vandq_s32(a.v, b.v)); }
+	friend FORCEINLINE Int4 operator^(Int4 a, Int4 b) { return Make(veorq_s32(a.v, b.v)); }
+	friend FORCEINLINE Int4 operator>>(Int4 a, int n) { return Make(vreinterpretq_s32_u32(vshlq_u32(vreinterpretq_u32_s32(a.v), vdupq_n_s32(-n)))); }
+	friend FORCEINLINE Int4 operator<<(Int4 a, int n) { return Make(vshlq_s32(a.v, vdupq_n_s32(n))); }
+	friend FORCEINLINE Int4 operator*(Int4 a, Int4 b) { return Make(vmulq_s32(a.v, b.v)); }
+#else
+	uint32_t v[4];
+	static FORCEINLINE Int4 Set(uint32_t x) { return { x, x, x, x }; }
+	static FORCEINLINE Int4 Set(uint32_t a, uint32_t b, uint32_t c, uint32_t d) { return { a, b, c, d }; }
+	static FORCEINLINE Int4 Load(const int32_t* p) { return { uint32_t(p[0]), uint32_t(p[1]), uint32_t(p[2]), uint32_t(p[3]) }; }
+	FORCEINLINE void Store(int32_t* p) const { p[0] = int32_t(v[0]); p[1] = int32_t(v[1]); p[2] = int32_t(v[2]); p[3] = int32_t(v[3]); }
+	friend FORCEINLINE Int4 operator+(Int4 a, Int4 b) { return { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] }; }
+	friend FORCEINLINE Int4 operator-(Int4 a, Int4 b) { return { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] }; }
+	friend FORCEINLINE Int4 operator&(Int4 a, Int4 b) { return { a.v[0] & b.v[0], a.v[1] & b.v[1], a.v[2] & b.v[2], a.v[3] & b.v[3] }; }
+	friend FORCEINLINE Int4 operator^(Int4 a, Int4 b) { return { a.v[0] ^ b.v[0], a.v[1] ^ b.v[1], a.v[2] ^ b.v[2], a.v[3] ^ b.v[3] }; }
+	friend FORCEINLINE Int4 operator>>(Int4 a, int n) { return { a.v[0] >> n, a.v[1] >> n, a.v[2] >> n, a.v[3] >> n }; }
+	friend FORCEINLINE Int4 operator<<(Int4 a, int n) { return { a.v[0] << n, a.v[1] << n, a.v[2] << n, a.v[3] << n }; }
+	friend FORCEINLINE Int4 operator*(Int4 a, Int4 b) { return { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] }; }
+#endif
+
+	static FORCEINLINE Int4 Iota() { return Set(0, 1, 2, 3); }
+
+	FORCEINLINE Int4& operator+=(Int4 b) { return *this = *this + b; }
+	FORCEINLINE Int4& operator^=(Int4 b) { return *this = *this ^ b; }
+	FORCEINLINE Int4& operator*=(Int4 b) { return *this = *this * b; }
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+struct Float4
+{
+	static constexpr size_t Width = 4;
+
+#if IS_SIMD_SSE2
+	__m128 v;
+	static FORCEINLINE Float4 Make(__m128 v) { Float4 r; r.v = v; return r; }
+	static FORCEINLINE Float4 Set(float x) { return Make(_mm_set1_ps(x)); }
+	static FORCEINLINE Float4 Set(float a, float b, float c, float d) { return Make(_mm_setr_ps(a, b, c, d)); }
+	static FORCEINLINE Float4 Load(const float* p) { return Make(_mm_loadu_ps(p)); }
+	FORCEINLINE void Store(float* p) const { _mm_storeu_ps(p, v); }
+	FORCEINLINE void Stream(float* p) const { _mm_stream_ps(p, v); }
+	friend FORCEINLINE Float4 operator+(Float4 a, Float4 b) { return Make(_mm_add_ps(a.v, b.v)); }
+	friend FORCEINLINE Float4 operator-(Float4 a, Float4 b) { return Make(_mm_sub_ps(a.v, b.v)); }
+	friend FORCEINLINE Float4 operator*(Float4 a, Float4 b) { return Make(_mm_mul_ps(a.v, b.v)); }
+	friend FORCEINLINE Float4 operator&(Float4 a, Float4 b) { return Make(_mm_and_ps(a.v, b.v)); }
+	friend FORCEINLINE Float4 operator|(Float4 a, Float4 b) { return Make(_mm_or_ps(a.v, b.v)); }
+	friend FORCEINLINE Float4 operator^(Float4 a, Float4 b) { return Make(_mm_xor_ps(a.v, b.v)); }
+	friend FORCEINLINE Float4 operator>(Float4 a, Float4 b) { return Make(_mm_cmpgt_ps(a.v, b.v)); }
+	friend FORCEINLINE Float4 Select(Float4 mask, Float4 a, Float4 b) { return Make(_mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v))); }
+	friend FORCEINLINE Float4 Abs(Float4 a) { return Make(_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v)); }
+	friend FORCEINLINE Float4 ZipLow(Float4 a, Float4 b) { return Make(_mm_unpacklo_ps(a.v, b.v)); }
+	friend FORCEINLINE Float4 ZipHigh(Float4 a, Float4 b) { return Make(_mm_unpackhi_ps(a.v, b.v)); }
+#elif IS_SIMD_NEON
+	float32x4_t v;
+	static FORCEINLINE Float4 Make(float32x4_t v) { Float4 r; r.v = v; return r; }
+	static FORCEINLINE Float4 Set(float x) { return Make(vdupq_n_f32(x)); }
+	static FORCEINLINE Float4 Set(float a, float b, float c, float d) { const float t[4] = { a, b, c, d }; return Load(t); }
+	static FORCEINLINE Float4 Load(const float* p) { return Make(vld1q_f32(p)); }
+	FORCEINLINE void Store(float* p) const { vst1q_f32(p, v); }
+	FORCEINLINE void Stream(float* p) const { vst1q_f32(p, v); }
+	friend FORCEINLINE Float4 operator+(Float4 a, Float4 b) { return Make(vaddq_f32(a.v, b.v)); }
+	friend FORCEINLINE Float4 operator-(Float4 a, Float4 b) { return Make(vsubq_f32(a.v, b.v)); }
+	friend FORCEINLINE Float4 operator*(Float4 a, Float4 b) { return Make(vmulq_f32(a.v, b.v)); }
+	friend FORCEINLINE Float4 operator&(Float4 a, Float4 b) { return Make(vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a.v), vreinterpretq_u32_f32(b.v)))); }
+	friend FORCEINLINE Float4 operator|(Float4 a, Float4 b) { return Make(vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a.v), vreinterpretq_u32_f32(b.v)))); }
+	friend FORCEINLINE Float4 operator^(Float4 a, Float4 b) { return Make(vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(a.v), vreinterpretq_u32_f32(b.v)))); }
+	friend FORCEINLINE Float4 operator>(Float4 a, Float4 b) { return Make(vreinterpretq_f32_u32(vcgtq_f32(a.v, b.v))); }
+	friend FORCEINLINE Float4 Select(Float4 mask, Float4 a, Float4 b) { return Make(vbslq_f32(vreinterpretq_u32_f32(mask.v), a.v, b.v)); }
+	friend FORCEINLINE Float4 Abs(Float4 a) { return Make(vabsq_f32(a.v)); }
+	friend FORCEINLINE Float4 ZipLow(Float4 a, Float4 b) { return Make(vzip1q_f32(a.v, b.v)); }
+	friend FORCEINLINE Float4 ZipHigh(Float4 a, Float4 b) { return Make(vzip2q_f32(a.v, b.v)); }
+#else
+	float v[4];
+	static FORCEINLINE Float4 Set(float x) { return { x, x, x, x }; }
+	static FORCEINLINE Float4 Set(float a, float b, float c, float d) { return { a, b, c, d }; }
+	static FORCEINLINE Float4 Load(const float* p) { return { p[0], p[1], p[2], p[3] }; }
+	FORCEINLINE void Store(float* p) const { p[0] = v[0]; p[1] = v[1]; p[2] = v[2]; p[3] = v[3]; }
+	FORCEINLINE void Stream(float* p) const { Store(p); }
+	static FORCEINLINE uint32_t Bits(float x) { union { float f; uint32_t u; } t; t.f = x; return t.u; }
+	static FORCEINLINE float Float(uint32_t x) { union { float f; uint32_t u; } t; t.u = x; return t.f; }
+	template <typename Op> static FORCEINLINE Float4 Map(Float4 a, Float4 b, Op op) { return { op(a.v[0], b.v[0]), op(a.v[1], b.v[1]), op(a.v[2], b.v[2]), op(a.v[3], b.v[3]) }; }
+	friend FORCEINLINE Float4 operator+(Float4 a, Float4 b) { return Map(a, b, [](float x, float y) { return x + y; }); }
+	friend FORCEINLINE Float4 operator-(Float4 a, Float4 b) { return Map(a, b, [](float x, float y) { return x - y; }); }
+	friend FORCEINLINE Float4 operator*(Float4 a, Float4 b) { return Map(a, b, [](float x, float y) { return x * y; }); }
+	friend FORCEINLINE Float4 operator&(Float4 a, Float4 b) { return Map(a, b, [](float x, float y) { return Float(Bits(x) & Bits(y)); }); }
+	friend FORCEINLINE Float4 operator|(Float4 a, Float4 b) { return Map(a, b, [](float x, float y) { return Float(Bits(x) | Bits(y)); }); }
+	friend FORCEINLINE Float4 operator^(Float4 a, Float4 b) { return Map(a, b, [](float x, float y) { return Float(Bits(x) ^ Bits(y)); }); }
+	friend FORCEINLINE Float4 operator>(Float4 a, Float4 b) { return Map(a, b, [](float x, float y) { return Float(x > y ? ~0U : 0U); }); }
+	friend FORCEINLINE Float4 Select(Float4 mask, Float4 a, Float4 b) { return (mask & a) | Map(mask, b, [](float m, float y) { return Float(~Bits(m) & Bits(y)); }); }
+	friend FORCEINLINE Float4 Abs(Float4 a) { return Map(a, a, [](float x, float) { return Float(Bits(x) & 0x7FFFFFFF); }); }
+	friend FORCEINLINE Float4 ZipLow(Float4 a, Float4 b) { return { a.v[0], b.v[0], a.v[1], b.v[1] }; }
+	friend FORCEINLINE Float4 ZipHigh(Float4 a, Float4 b) { return { a.v[2], b.v[2], a.v[3], b.v[3] }; }
+#endif
+
+	FORCEINLINE Float4& operator+=(Float4 b) { return *this = *this + b; }
+	FORCEINLINE Float4& operator*=(Float4 b) { return *this = *this * b; }
+};
+
+// Streaming stores bypass the cache (MOVNTPS), the pointer must be aligned to 16 bytes. MSVC has no intrinsic for
+// the non-temporal stores of ARM64 (STNP), so it's a regular store there and on targets without SIMD.
+// Streaming stores are weakly ordered, call StreamFence() before other threads may read the data.
+#define IS_SIMD_STREAMING IS_SIMD_SSE2
+
+FORCEINLINE void StreamFence()
+{
+#if IS_SIMD_STREAMING
+	_mm_sfence();
+#endif
+}
+
+// Transpose 4 vectors as rows of a 4x4 matrix.
+FORCEINLINE void Transpose(Float4& a, Float4& b, Float4& c, Float4& d)
+{
+	Float4 ac_low = ZipLow(a, c), ac_high = ZipHigh(a, c);
+	Float4 bd_low = ZipLow(b, d), bd_high = ZipHigh(b, d);
+	a = ZipLow(ac_low, bd_low);
+	b = ZipHigh(ac_low, bd_low);
+	c = ZipLow(ac_high, bd_high);
+	d = ZipHigh(ac_high, bd_high);
+}
+
+// Convert lanes interpreted as signed integers to floats.
+FORCEINLINE Float4 ToFloat(Int4 a)
+{
+#if IS_SIMD_SSE2
+	return Float4::Make(_mm_cvtepi32_ps(a.v));
+#elif IS_SIMD_NEON
+	return Float4::Make(vcvtq_f32_s32(a.v));
+#else
+	return { float(int32_t(a.v[0])), float(int32_t(a.v[1])), float(int32_t(a.v[2])), float(int32_t(a.v[3])) };
+#endif
+}
+
+// Convert lanes to signed integers rounding to nearest. Lanes must be in the int32 range.
+FORCEINLINE Int4 ToInt(Float4 a)
+{
+#if IS_SIMD_SSE2
+	return Int4::Make(_mm_cvtps_epi32(a.v));
+#elif IS_SIMD_NEON
+	return Int4::Make(vcvtnq_s32_f32(a.v));
+#else
+	// Adding 1.5 * 2^52 leaves the rounded integer in the low bits of the double. It avoids the slow x87 _ftol2().
+	auto round = [](float x) { union { double d; uint32_t u[2]; } t; t.d = double(x) + 6755399441055744.0; return t.u[0]; };
+	return { round(a.v[0]), round(a.v[1]), round(a.v[2]), round(a.v[3]) };
+#endif
+}
+
+// Store lanes as 4 signed 16-bit integers with saturation.
+FORCEINLINE void StoreInt16(int16_t* p, Int4 a)
+{
+#if IS_SIMD_SSE2
+	_mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packs_epi32(a.v, a.v));
+#elif IS_SIMD_NEON
+	vst1_s16(p, vqmovn_s32(a.v));
+#else
+	auto saturate = [](uint32_t x) { int32_t v = int32_t(x); return int16_t(v < -32768 ? -32768 : v > 32767 ? 32767 : v); };
+	for (size_t i = 0; i < 4; i++) { p[i] = saturate(a.v[i]); }
+#endif
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+// 8-lane vector types of AVX2 with the same interface. It's not the baseline of any target, so they are used only by
+// kernels that are selected at runtime when the CPU supports AVX2 (see CpuFeatures). 32-bit MSVC can't pass aligned
+// types by value, so they are not available there.
+
+#if IS_X8664
+
+#include <immintrin.h>
+#define IS_SIMD_AVX2    1
+
+struct Int8
+{
+	static constexpr size_t Width = 8;
+
+	__m256i v;
+	static FORCEINLINE Int8 Make(__m256i v) { Int8 r; r.v = v; return r; }
+	static FORCEINLINE Int8 Set(uint32_t x) { return Make(_mm256_set1_epi32(int(x))); }
+	static FORCEINLINE Int8 Iota() { return Make(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)); }
+	static FORCEINLINE Int8 Load(const int32_t* p) { return Make(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))); }
+	FORCEINLINE void Store(int32_t* p) const { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+	friend FORCEINLINE Int8 operator+(Int8 a, Int8 b) { return Make(_mm256_add_epi32(a.v, b.v)); }
+	friend FORCEINLINE Int8 operator-(Int8 a, Int8 b) { return Make(_mm256_sub_epi32(a.v, b.v)); }
+	friend FORCEINLINE Int8 operator&(Int8 a, Int8 b) { return Make(_mm256_and_si256(a.v, b.v)); }
+	friend FORCEINLINE Int8 operator^(Int8 a, Int8 b) { return Make(_mm256_xor_si256(a.v, b.v)); }
+	friend FORCEINLINE Int8 operator>>(Int8 a, int n) { return Make(_mm256_srl_epi32(a.v, _mm_cvtsi32_si128(n))); }
+	friend FORCEINLINE Int8 operator<<(Int8 a, int n) { return Make(_mm256_sll_epi32(a.v, _mm_cvtsi32_si128(n))); }
+	friend FORCEINLINE Int8 operator*(Int8 a, Int8 b) { return Make(_mm256_mullo_epi32(a.v, b.v)); }
+
+	FORCEINLINE Int8& operator+=(Int8 b) { return *this = *this + b; }
+	FORCEINLINE Int8& operator^=(Int8 b) { return *this = *this ^ b; }
+	FORCEINLINE Int8& operator*=(Int8 b) { return *this = *this * b; }
+};
+
+struct Float8
+{
+	static constexpr size_t Width = 8;
+
+	__m256 v;
+	static FORCEINLINE Float8 Make(__m256 v) { Float8 r; r.v = v; return r; }
+	static FORCEINLINE Float8 Set(float x) { return Make(_mm256_set1_ps(x)); }
+	static FORCEINLINE Float8 Load(const float* p) { return Make(_mm256_loadu_ps(p)); }
+	FORCEINLINE void Store(float* p) const { _mm256_storeu_ps(p, v); }
+	friend FORCEINLINE Float8 operator+(Float8 a, Float8 b) { return Make(_mm256_add_ps(a.v, b.v)); }
+	friend FORCEINLINE Float8 operator-(Float8 a, Float8 b) { return Make(_mm256_sub_ps(a.v, b.v)); }
+	friend FORCEINLINE Float8 operator*(Float8 a, Float8 b) { return Make(_mm256_mul_ps(a.v, b.v)); }
+	friend FORCEINLINE Float8 operator&(Float8 a, Float8 b) { return Make(_mm256_and_ps(a.v, b.v)); }
+	friend FORCEINLINE Float8 operator|(Float8 a, Float8 b) { return Make(_mm256_or_ps(a.v, b.v)); }
+	friend FORCEINLINE Float8 operator^(Float8 a, Float8 b) { return Make(_mm256_xor_ps(a.v, b.v)); }
+	friend FORCEINLINE Float8 operator>(Float8 a, Float8 b) { return Make(_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ)); }
+	friend FORCEINLINE Float8 Select(Float8 mask, Float8 a, Float8 b) { return Make(_mm256_blendv_ps(b.v, a.v, mask.v)); }
+	friend FORCEINLINE Float8 Abs(Float8 a) { return Make(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v)); }
+
+	FORCEINLINE Float8& operator+=(Float8 b) { return *this = *this + b; }
+	FORCEINLINE Float8& operator*=(Float8 b) { return *this = *this * b; }
+};
+
+FORCEINLINE Float8 ToFloat(Int8 a)
+{
+	return Float8::Make(_mm256_cvtepi32_ps(a.v));
+}
+
+#else
+	#define IS_SIMD_AVX2    0
+#endif
+
+// ---------------------------------------------------------------------------------------------------------------------
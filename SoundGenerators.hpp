@@ -0,0 +1,1694 @@
+#pragma once
+
+#include "Common.hpp"
+#include "Common/Simd.hpp"
+#include "Common/CpuFeatures.hpp"
+#include <type_traits> // std::is_same_v.
+
+//
+// Sound generation kernels. They fill a block of mono float samples, so they don't know anything about device formats.
+// Vectorized kernels write whole vectors, so the output must have room for the count rounded up to 8 (the widest
+// vector). Kernels that have versions for newer instruction sets are templates of the vector types.
+//
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+//
+// Sine oscillators use a wrapped 32-bit phase accumulator (NCO): the full 2^32 range is one period, so the phase never
+// grows and costs the same on day 30 as on day 1. Use SinePhaseIncrement() to get the increment for a frequency.
+//
+
+inline uint32_t SinePhaseIncrement(double frequency, uint32_t sample_rate)
+{
+	return uint32_t(uint64_t(frequency / sample_rate * 4294967296.0 + 0.5));
+}
+
+//
+// Vectorized sine: out[i] = sin(phase + i * increment) * amplitude.
+//
+// The signed phase of each lane maps to [-pi, pi) directly. It is reflected into [-pi/2, pi/2], where the Taylor
+// series up to the 11th power has error below 1e-7. It is precise enough for the float output and doesn't need libm.
+// Along with the rounding of the phase to float, the output differs from sin() by less than 3e-7 of the amplitude.
+// Tests/GeneratorPrecision.cpp checks it.
+//
+template <typename F = Float4, typename I = Int4>
+inline void GenerateSine(float* out, size_t count, uint32_t phase, uint32_t increment, float amplitude)
+{
+	const float pi = 3.14159265f;
+
+	I lane_phase = I::Set(phase) + I::Iota() * I::Set(increment);
+	I lane_step = I::Set(increment * uint32_t(I::Width));
+
+	for (size_t i = 0; i < count; i += F::Width)
+	{
+		F x = ToFloat(lane_phase) * F::Set(pi / 2147483648.0f);
+		lane_phase += lane_step;
+
+		// Reflect to [-pi/2, pi/2] using sin(x) = sin(+-pi - x).
+		F sign = x & F::Set(-0.0f);
+		x = Select((x ^ sign) > F::Set(pi / 2), (F::Set(pi) | sign) - x, x);
+
+		F x2 = x * x;
+		F y = F::Set(-1.0f / 39916800);
+		y = y * x2 + F::Set(1.0f / 362880);
+		y = y * x2 + F::Set(-1.0f / 5040);
+		y = y * x2 + F::Set(1.0f / 120);
+		y = y * x2 + F::Set(-1.0f / 6);
+		y = y * x2 + F::Set(1.0f);
+		y = y * x * F::Set(amplitude);
+
+		y.Store(out + i);
+	}
+}
+
+typedef void (*SineFunc)(float* out, size_t count, uint32_t phase, uint32_t increment, float amplitude);
+
+//
+// Scalar sine based on a lookup table with linear interpolation. The table is shared by all sessions of the process.
+// Its 1024 steps per period give error below 5e-6, and it has one extra entry, so interpolation doesn't need to wrap.
+//
+
+const uint32_t SINE_TABLE_BITS = 10;
+inline float g_sine_table[(1 << SINE_TABLE_BITS) + 1];
+inline int32_t g_sine_table_q30[(1 << SINE_TABLE_BITS) + 1]; // For fixed-point kernels.
+
+// It's not thread safe. Call it on the main thread before starting sessions.
+inline void InitSineTable()
+{
+	if (g_sine_table[1 << (SINE_TABLE_BITS - 2)] != 0) { return; }
+
+	for (uint32_t i = 0; i <= (1 << SINE_TABLE_BITS); i++)
+	{
+		double value = sin(i * (M_PI * 2) / (1 << SINE_TABLE_BITS));
+		g_sine_table[i] = float(value);
+		g_sine_table_q30[i] = int32_t(floor(value * (1 << 30) + 0.5));
+	}
+}
+
+inline void GenerateSineFromTable(float* out, size_t count, uint32_t phase, uint32_t increment, float amplitude)
+{
+	const uint32_t FRACTION_BITS = 32 - SINE_TABLE_BITS;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		uint32_t index = phase >> FRACTION_BITS;
+		float fraction = float(int32_t(phase & ((1 << FRACTION_BITS) - 1))) * (1.0f / (1 << FRACTION_BITS));
+		float a = g_sine_table[index];
+		float b = g_sine_table[index + 1];
+		out[i] = (a + (b - a) * fraction) * amplitude;
+		phase += increment;
+	}
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+//
+// Noise generators use a counter-based PRNG: each sample is a hash of its index, so there is no serial state between
+// samples, lanes are independent, and the same seed and counter always give the same output. The seed is added to the
+// counter, so sessions with different seeds read different parts of the same 2^32 samples long sequence.
+// The hash is "lowbias32" by Chris Wellons. It is a bijection, so the sequence doesn't repeat within the period.
+//
+
+// The hash of all lanes.
+template <typename I>
+FORCEINLINE I HashCounter(I x)
+{
+	x ^= x >> 16;
+	x *= I::Set(0x7FEB352D);
+	x ^= x >> 15;
+	x *= I::Set(0x846CA68B);
+	x ^= x >> 16;
+	return x;
+}
+
+// The same hash of a single value.
+FORCEINLINE uint32_t HashCounter(uint32_t x)
+{
+	x ^= x >> 16;
+	x *= 0x7FEB352D;
+	x ^= x >> 15;
+	x *= 0x846CA68B;
+	x ^= x >> 16;
+	return x;
+}
+
+//
+// Uniform white noise: out[i] = hash(counter + i + seed) mapped to [-amplitude, amplitude].
+//
+template <typename F = Float4, typename I = Int4>
+inline void GenerateUniform(float* out, size_t count, uint32_t counter, uint32_t seed, float amplitude)
+{
+	I x = I::Set(counter + seed) + I::Iota();
+	I step = I::Set(uint32_t(I::Width));
+
+	for (size_t i = 0; i < count; i += F::Width)
+	{
+		// The hash as a signed integer is in [-2^31, 2^31), which rounds to [-1, 1] in floats.
+		F y = ToFloat(HashCounter(x)) * F::Set(amplitude / 2147483648.0f);
+		y.Store(out + i);
+		x += step;
+	}
+}
+
+typedef void (*UniformFunc)(float* out, size_t count, uint32_t counter, uint32_t seed, float amplitude);
+
+//
+// Raw random numbers: out[i] = hash(counter + i + seed) as a signed integer.
+//
+inline void GenerateRandom(int32_t* out, size_t count, uint32_t counter, uint32_t seed)
+{
+	Int4 x = Int4::Set(counter + seed) + Int4::Set(0, 1, 2, 3);
+	Int4 step = Int4::Set(uint32_t(Int4::Width));
+
+	for (size_t i = 0; i < count; i += Int4::Width)
+	{
+		HashCounter(x).Store(out + i);
+		x += step;
+	}
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+//
+// Pink noise using Paul Kellet's method. His coefficients are used at 48 kHz. For other sample rates, the poles are moved
+// to the same frequencies (p' = p^(48000/rate)) keeping the gains of the sections at low frequencies, and all gains are
+// scaled by sqrt(rate/48000), so the noise has the same level per Hz in the audible band at any rate. The pole near
+// Nyquist and the direct terms only shape the top of the spectrum, so they are just scaled.
+//
+
+struct PinkNoiseFilter
+{
+	double poles[6];
+	double gains[6];
+	double direct;
+	double delayed;
+};
+
+inline PinkNoiseFilter MakePinkNoiseFilter(uint32_t sample_rate)
+{
+	const double poles[6] = { 0.99886, 0.99332, 0.96900, 0.86650, 0.55000, -0.7616 };
+	const double gains[6] = { 0.0555179, 0.0750759, 0.1538520, 0.3104856, 0.5329522, -0.0168980 };
+	double ratio = 48000.0 / sample_rate;
+	double scale = sqrt(1.0 / ratio);
+
+	PinkNoiseFilter filter;
+	for (size_t i = 0; i < 6; i++)
+	{
+		filter.poles[i] = (poles[i] > 0) ? pow(poles[i], ratio) : poles[i];
+		filter.gains[i] = (poles[i] > 0) ? gains[i] * (1.0 - filter.poles[i]) / (1.0 - poles[i]) * scale : gains[i] * scale;
+	}
+	filter.direct = 0.5362 * scale;
+	filter.delayed = 0.115926 * scale;
+	return filter;
+}
+
+//
+// The input is white noise in [-1, 1], it's replaced with the output in place. The state is 8 doubles, zeroed state is valid.
+//
+inline void FilterPinkNoise(float* samples, size_t count, double* state, const PinkNoiseFilter& filter, float amplitude)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		double white = samples[i];
+
+		state[0] = filter.poles[0] * state[0] + white * filter.gains[0];
+		state[1] = filter.poles[1] * state[1] + white * filter.gains[1];
+		state[2] = filter.poles[2] * state[2] + white * filter.gains[2];
+		state[3] = filter.poles[3] * state[3] + white * filter.gains[3];
+		state[4] = filter.poles[4] * state[4] + white * filter.gains[4];
+		state[5] = filter.poles[5] * state[5] + white * filter.gains[5];
+		double value = state[0] + state[1] + state[2] + state[3] + state[4] + state[5] + state[6] + white * filter.direct;
+		value *= 0.11; // (roughly) compensate for gain.
+		state[6] = white * filter.delayed;
+
+		samples[i] = float(value * amplitude);
+	}
+}
+
+//
+// Same filter in single precision with the poles in vector lanes, so it needs 2 vectors per frame instead of 7 scalar
+// double operations. Compared to the double version, the output differs by less than 2e-6 of the amplitude (measured
+// over 10^8 frames by Tests/GeneratorPrecision.cpp), which is far below the 16-bit and 24-bit output steps at
+// keep-alive amplitudes.
+// The state is 9 floats, zeroed state is valid.
+//
+inline void FilterPinkNoiseFloat(float* samples, size_t count, float* state, const PinkNoiseFilter& filter, float amplitude)
+{
+	// Lanes are poles 0..3 and pole 4, pole 5, the delayed white term, the direct white term.
+	// The delayed term is computed from the current white value, so its delay is applied to the sum afterwards.
+	const double* p = filter.poles;
+	const double* g = filter.gains;
+	const Float4 pole_a = Float4::Set(float(p[0]), float(p[1]), float(p[2]), float(p[3]));
+	const Float4 gain_a = Float4::Set(float(g[0]), float(g[1]), float(g[2]), float(g[3]));
+	const Float4 pole_b = Float4::Set(float(p[4]), float(p[5]), 0.0f, 0.0f);
+	const Float4 gain_b = Float4::Set(float(g[4]), float(g[5]), float(filter.delayed), float(filter.direct));
+	const float delayed_gain = float(filter.delayed);
+	const float scale = 0.11f * amplitude; // (roughly) compensate for gain.
+
+	Float4 a = Float4::Load(state);
+	Float4 b = Float4::Load(state + 4);
+	float prev_white = state[8];
+	size_t i = 0;
+
+	// 4 frames per iteration. The lanes of the 4 frames are transposed, so they are summed vertically.
+	for (; i + 4 <= count; i += 4)
+	{
+		Float4 v[4];
+		for (size_t j = 0; j < 4; j++)
+		{
+			Float4 white = Float4::Set(samples[i + j]);
+			a = a * pole_a + white * gain_a;
+			b = b * pole_b + white * gain_b;
+			v[j] = a + b;
+		}
+
+		Float4 t0 = ZipLow(v[0], v[2]), t1 = ZipLow(v[1], v[3]), t2 = ZipHigh(v[0], v[2]), t3 = ZipHigh(v[1], v[3]);
+		Float4 sum = (ZipLow(t0, t1) + ZipHigh(t0, t1)) + (ZipLow(t2, t3) + ZipHigh(t2, t3));
+
+		Float4 white = Float4::Load(samples + i);
+		Float4 prev = Float4::Set(prev_white, samples[i], samples[i + 1], samples[i + 2]);
+		prev_white = samples[i + 3];
+
+		Float4 y = (sum + (prev - white) * Float4::Set(delayed_gain)) * Float4::Set(scale);
+		y.Store(samples + i);
+	}
+
+	for (; i < count; i++)
+	{
+		Float4 white = Float4::Set(samples[i]);
+		a = a * pole_a + white * gain_a;
+		b = b * pole_b + white * gain_b;
+
+		alignas(16) float v[4];
+		(a + b).Store(v);
+		float value = (v[0] + v[1]) + (v[2] + v[3]) + (prev_white - samples[i]) * delayed_gain;
+		prev_white = samples[i];
+		samples[i] = value * scale;
+	}
+
+	a.Store(state);
+	b.Store(state + 4);
+	state[8] = prev_white;
+}
+
+//
+// Brown noise from SoX with a leaky integrator to reduce low frequency humming: v = leak * (v + gain * white).
+// The coefficients are for 48 kHz. For other sample rates, the leak is moved to the same frequency and the gain is
+// scaled by sqrt(48000/rate), so the spectrum is the same and the distribution of the state doesn't depend on the rate.
+//
+
+struct BrownNoiseFilter
+{
+	double leak;
+	double gain;
+};
+
+inline BrownNoiseFilter MakeBrownNoiseFilter(uint32_t sample_rate)
+{
+	double ratio = 48000.0 / sample_rate;
+	return { pow(1.0 / 1.02, ratio), sqrt(ratio) / 16 };
+}
+
+//
+// The input is white noise in [-1, 1], it's replaced with the output in place. Only the integrator is serial, the rest
+// is done 4 lanes at a time.
+//
+inline void FilterBrownNoise(float* samples, size_t count, double& state, const BrownNoiseFilter& filter, float amplitude)
+{
+	// At 48 kHz, the leak keeps |state| below (1/16) / (1.02 - 1) = 3.125, and the bound grows as sqrt(rate/48000).
+	// The state is about 0.2 RMS though, so it practically never reaches 7 where the mirroring below stops working.
+	// The recurrence is v[n] = k * v[n-1] + g * x[n]. It's unrolled, so the dependency chain is one step per 4 frames:
+	// v[n+3] = k^4 * v[n-1] + p[3], where the partial sums p[] don't depend on the state.
+	const double k1 = filter.leak, k2 = k1 * k1, k3 = k2 * k1, k4 = k3 * k1;
+	const double g = k1 * filter.gain;
+	double value = state;
+	size_t i = 0;
+
+	for (; i + 4 <= count; i += 4)
+	{
+		double p0 = samples[i] * g;
+		double p1 = p0 * k1 + samples[i + 1] * g;
+		double p2 = p1 * k1 + samples[i + 2] * g;
+		double p3 = p2 * k1 + samples[i + 3] * g;
+
+		samples[i] = float(value * k1 + p0);
+		samples[i + 1] = float(value * k2 + p1);
+		samples[i + 2] = float(value * k3 + p2);
+		value = value * k4 + p3;
+		samples[i + 3] = float(value);
+	}
+
+	for (; i < count; i++)
+	{
+		value = value * k1 + samples[i] * g;
+		samples[i] = float(value);
+	}
+
+	state = value;
+
+	// Normalize values out of the -1..1 range using "mirroring".
+	// Example: 0.8, 0.9, 1.0, 0.9, 0.8, ..., -0.8, -0.9, -1.0, -0.9, -0.8, ...
+	// For |x| in [0, 7], it is 1 - ||x| - 3| - 2| with the sign of x.
+	for (size_t i = 0; i < count; i += Float4::Width)
+	{
+		Float4 x = Float4::Load(samples + i);
+		Float4 sign = x & Float4::Set(-0.0f);
+		Float4 y = Float4::Set(1.0f) - Abs(Abs((x ^ sign) - Float4::Set(3.0f)) - Float4::Set(2.0f));
+		y = (y ^ sign) * Float4::Set(amplitude);
+		y.Store(samples + i);
+	}
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+//
+// Pink noise using the Voss-McCartney algorithm. There are rows of random values, row K is updated every 2^(K+1)
+// samples, and the output is their sum plus a fresh white value. Frame N updates only the row selected by the number
+// of trailing zeros of N, so it's O(1) per sample regardless of the number of rows.
+//
+// 15 rows give -3 dB per octave down to about 1 Hz at 48 kHz. Rows are periods in samples, so there is a row more
+// for each doubling of the sample rate, then the spectrum is the same at any rate. The rows are 27-bit integers, so
+// the running sum of the rows and the white value always fits 32 bits and is exact: it never drifts, and the state
+// can't get denormal.
+//
+// The state is PINK_NOISE_MAX_ROWS rows followed by their sum. Zeroed state is valid.
+//
+
+const uint32_t PINK_NOISE_MAX_ROWS = 19;
+
+inline uint32_t GetPinkNoiseRows(uint32_t sample_rate)
+{
+	int32_t rows = 15 + int32_t(floor(log2(sample_rate / 48000.0) + 0.5));
+	return uint32_t(std::clamp(rows, 12, int32_t(PINK_NOISE_MAX_ROWS)));
+}
+
+inline void GeneratePinkNoiseVoss(float* out, size_t count, uint32_t counter, uint32_t seed, int32_t* state, uint32_t row_count, float amplitude)
+{
+	const size_t CHUNK_FRAMES = 64;
+	alignas(16) int32_t random[CHUNK_FRAMES];
+	alignas(16) int32_t sums[CHUNK_FRAMES];
+
+	// Same gain as Paul Kellet's filter has: RMS of about 0.19 at full amplitude.
+	const float scale = amplitude * (0.193f / 2.3094f / (1 << 26));
+
+	int32_t* rows = state;
+	int32_t sum = state[PINK_NOISE_MAX_ROWS];
+
+	for (size_t chunk_start = 0; chunk_start < count; chunk_start += CHUNK_FRAMES)
+	{
+		size_t chunk_frames = std::min(count - chunk_start, CHUNK_FRAMES);
+		uint32_t chunk_counter = counter + uint32_t(chunk_start);
+
+		// One hash per frame: the low 16 bits are the new row value, the high 16 bits are the white value.
+		GenerateRandom(random, chunk_frames, chunk_counter, seed);
+
+		// The only serial part: update one row per frame and remember the sum of the rows.
+		for (size_t i = 0; i < chunk_frames; i++)
+		{
+			unsigned long row;
+			if (_BitScanForward(&row, chunk_counter + uint32_t(i)) && row < row_count)
+			{
+				int32_t value = int32_t(uint32_t(random[i]) << 16) >> 5;
+				sum += value - rows[row];
+				rows[row] = value;
+			}
+
+			sums[i] = sum;
+		}
+
+		// The white value is added with the same weight as a row has.
+		for (size_t i = 0; i < chunk_frames; i += Float4::Width)
+		{
+			Int4 white = Int4::Load(random + i) & Int4::Set(0xFFFF0000);
+			Float4 y = ToFloat(Int4::Load(sums + i)) * Float4::Set(scale) + ToFloat(white) * Float4::Set(scale / 32);
+			y.Store(out + chunk_start + i);
+		}
+	}
+
+	state[PINK_NOISE_MAX_ROWS] = sum;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+//
+// Subsonic noise: white noise through a 4th order Butterworth low-pass filter (a cascade of 2 biquads). Nothing is
+// left above the cutoff to generate at the output rate, so the noise is generated and filtered at a low rate of about
+// 100 times the cutoff and then linearly interpolated. It costs about one multiply-add per frame, and the filter is
+// well conditioned (a cutoff of 15 Hz at 48 kHz would need poles very close to 1). Interpolation images at multiples
+// of the low rate are attenuated by more than 80 dB.
+//
+
+struct SubsonicFilter
+{
+	double b[2][3];
+	double a[2][2];
+	double gain;
+	uint32_t factor;
+};
+
+inline SubsonicFilter MakeSubsonicFilter(double cutoff, uint32_t sample_rate)
+{
+	SubsonicFilter filter;
+	filter.factor = std::max(uint32_t(sample_rate / (cutoff * 100)), 1U);
+	double low_rate = double(sample_rate) / filter.factor;
+	cutoff = std::min(cutoff, low_rate / 4);
+
+	// Biquads from the Audio EQ Cookbook with Q of the Butterworth pole pairs: 1 / (2 * cos(pi/8)) and 1 / (2 * cos(3pi/8)).
+	const double q[2] = { 0.54119610, 1.30656296 };
+	double w0 = 2 * M_PI * cutoff / low_rate;
+
+	for (size_t i = 0; i < 2; i++)
+	{
+		double alpha = sin(w0) / (2 * q[i]);
+		double a0 = 1 + alpha;
+		filter.b[i][0] = (1 - cos(w0)) / 2 / a0;
+		filter.b[i][1] = (1 - cos(w0)) / a0;
+		filter.b[i][2] = (1 - cos(w0)) / 2 / a0;
+		filter.a[i][0] = -2 * cos(w0) / a0;
+		filter.a[i][1] = (1 - alpha) / a0;
+	}
+
+	// White noise in [-1, 1] has RMS of 1/sqrt(3), the noise bandwidth of the filter is 1.026 of the cutoff.
+	// The output is scaled to RMS of 0.25, so peaks are about the amplitude.
+	filter.gain = 0.25 / (sqrt(1.0 / 3) * sqrt(2 * 1.0262 * cutoff / low_rate));
+	return filter;
+}
+
+// The state has the biquads (transposed direct form II), the previous and the next low rate samples, and the position
+// between them. The position wraps at the decimation factor by itself, so it stays continuous when the frame counter
+// of the session wraps around (a factor doesn't have to divide 2^32). Zeroed state is valid.
+struct SubsonicState
+{
+	double biquads[4];
+	double prev;
+	double next;
+	uint32_t position;
+	uint32_t low_counter;
+};
+
+inline void GenerateSubsonicNoise(float* out, size_t count, uint32_t seed, SubsonicState& state, const SubsonicFilter& filter, float amplitude)
+{
+	const double step = 1.0 / filter.factor;
+	double prev = state.prev;
+	double next = state.next;
+	uint32_t position = state.position;
+
+	for (size_t i = 0; i < count;)
+	{
+		if (position == 0)
+		{
+			double x = int32_t(HashCounter(state.low_counter++ + seed)) / 2147483648.0;
+
+			for (size_t j = 0; j < 2; j++)
+			{
+				double y = filter.b[j][0] * x + state.biquads[j * 2];
+				state.biquads[j * 2] = filter.b[j][1] * x - filter.a[j][0] * y + state.biquads[j * 2 + 1];
+				state.biquads[j * 2 + 1] = filter.b[j][2] * x - filter.a[j][1] * y;
+				x = y;
+			}
+
+			prev = next;
+			next = x * filter.gain;
+		}
+
+		size_t run = std::min(count - i, size_t(filter.factor - position));
+		float start = float((prev + (next - prev) * step * position) * amplitude);
+		float slope = float((next - prev) * step * amplitude);
+
+		for (size_t j = 0; j < run; j++)
+		{
+			out[i + j] = start + slope * float(j);
+		}
+
+		i += run;
+		position += uint32_t(run);
+		if (position == filter.factor) { position = 0; }
+	}
+
+	state.prev = prev;
+	state.next = next;
+	state.position = position;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+//
+// Complex FFT on split arrays of real and imaginary parts, in place. The forward transform takes natural order and
+// leaves the spectrum in bit-reversed order, the inverse one takes bit-reversed order and returns natural order, so
+// convolution never reorders anything. The inverse transform is not scaled. The size is a power of two, at least 16.
+//
+// Twiddles are 2 arrays of the FFT size: cos and -sin of pi*j/h for each radix-2 stage with half size h, starting at
+// index h. Pairs of radix-2 stages are merged into radix-4 passes, so there are half as many passes over the data and
+// fewer multiplications. Passes are vectorized over butterflies, the last one works inside groups of 4 transposed to
+// vectors. If the number of stages is odd, the forward transform starts and the inverse one ends with a radix-2 stage.
+//
+
+inline void InitFftTwiddles(float* twiddles, size_t size)
+{
+	for (size_t h = 1; h < size; h *= 2)
+	{
+		for (size_t j = 0; j < h; j++)
+		{
+			twiddles[h + j] = float(cos(M_PI * j / h));
+			twiddles[size + h + j] = float(-sin(M_PI * j / h));
+		}
+	}
+
+	twiddles[0] = twiddles[size] = 0.0f;
+}
+
+FORCEINLINE void MulComplex(Float4& re, Float4& im, Float4 w_re, Float4 w_im)
+{
+	Float4 t = re * w_re - im * w_im;
+	im = re * w_im + im * w_re;
+	re = t;
+}
+
+FORCEINLINE void MulComplexConj(Float4& re, Float4& im, Float4 w_re, Float4 w_im)
+{
+	Float4 t = re * w_re + im * w_im;
+	im = im * w_re - re * w_im;
+	re = t;
+}
+
+inline void FftForward(float* re, float* im, size_t size, const float* twiddles)
+{
+	const float* tw_re = twiddles;
+	const float* tw_im = twiddles + size;
+	size_t q = size / 4;
+	unsigned long stages = 0;
+	_BitScanForward(&stages, uint32_t(size));
+
+	if (stages & 1)
+	{
+		// Radix-2 stage with h = size/2.
+		for (size_t j = 0; j < size / 2; j += Float4::Width)
+		{
+			Float4 ar = Float4::Load(re + j), ai = Float4::Load(im + j);
+			Float4 br = Float4::Load(re + j + size / 2), bi = Float4::Load(im + j + size / 2);
+			Float4 dr = ar - br, di = ai - bi;
+			MulComplex(dr, di, Float4::Load(tw_re + size / 2 + j), Float4::Load(tw_im + size / 2 + j));
+			(ar + br).Store(re + j); (ai + bi).Store(im + j);
+			dr.Store(re + j + size / 2); di.Store(im + j + size / 2);
+		}
+
+		q /= 2;
+	}
+
+	for (; q >= Float4::Width; q /= 4)
+	{
+		for (size_t k = 0; k < size; k += 4 * q)
+		{
+			for (size_t j = 0; j < q; j += Float4::Width)
+			{
+				float* pr = re + k + j;
+				float* pi = im + k + j;
+				Float4 r0 = Float4::Load(pr), r1 = Float4::Load(pr + q), r2 = Float4::Load(pr + 2 * q), r3 = Float4::Load(pr + 3 * q);
+				Float4 i0 = Float4::Load(pi), i1 = Float4::Load(pi + q), i2 = Float4::Load(pi + 2 * q), i3 = Float4::Load(pi + 3 * q);
+
+				// t = exp(-2*pi*i*j/(4q)), the twiddles are t^2, t and t^3.
+				Float4 w1r = Float4::Load(tw_re + 2 * q + j), w1i = Float4::Load(tw_im + 2 * q + j);
+				Float4 w2r = Float4::Load(tw_re + q + j), w2i = Float4::Load(tw_im + q + j);
+				Float4 w3r = w1r, w3i = w1i;
+				MulComplex(w3r, w3i, w2r, w2i);
+
+				Float4 sr = r0 + r2, si = i0 + i2, dr = r0 - r2, di = i0 - i2;
+				Float4 tr = r1 + r3, ti = i1 + i3, ur = r1 - r3, ui = i1 - i3;
+				r0 = sr + tr; i0 = si + ti;
+				r1 = sr - tr; i1 = si - ti;
+				r2 = dr + ui; i2 = di - ur; // (x0 - x2) - i(x1 - x3)
+				r3 = dr - ui; i3 = di + ur; // (x0 - x2) + i(x1 - x3)
+				MulComplex(r1, i1, w2r, w2i);
+				MulComplex(r2, i2, w1r, w1i);
+				MulComplex(r3, i3, w3r, w3i);
+
+				r0.Store(pr); r1.Store(pr + q); r2.Store(pr + 2 * q); r3.Store(pr + 3 * q);
+				i0.Store(pi); i1.Store(pi + q); i2.Store(pi + 2 * q); i3.Store(pi + 3 * q);
+			}
+		}
+	}
+
+	for (size_t k = 0; k < size; k += 4 * Float4::Width)
+	{
+		Float4 r0 = Float4::Load(re + k), r1 = Float4::Load(re + k + 4), r2 = Float4::Load(re + k + 8), r3 = Float4::Load(re + k + 12);
+		Float4 i0 = Float4::Load(im + k), i1 = Float4::Load(im + k + 4), i2 = Float4::Load(im + k + 8), i3 = Float4::Load(im + k + 12);
+		Transpose(r0, r1, r2, r3);
+		Transpose(i0, i1, i2, i3);
+
+		// Radix-4 butterfly with q = 1, all twiddles are 1.
+		Float4 sr = r0 + r2, si = i0 + i2, dr = r0 - r2, di = i0 - i2;
+		Float4 tr = r1 + r3, ti = i1 + i3, ur = r1 - r3, ui = i1 - i3;
+		r0 = sr + tr; i0 = si + ti;
+		r1 = sr - tr; i1 = si - ti;
+		r2 = dr + ui; i2 = di - ur;
+		r3 = dr - ui; i3 = di + ur;
+
+		Transpose(r0, r1, r2, r3);
+		Transpose(i0, i1, i2, i3);
+		r0.Store(re + k); r1.Store(re + k + 4); r2.Store(re + k + 8); r3.Store(re + k + 12);
+		i0.Store(im + k); i1.Store(im + k + 4); i2.Store(im + k + 8); i3.Store(im + k + 12);
+	}
+}
+
+inline void FftInverse(float* re, float* im, size_t size, const float* twiddles)
+{
+	const float* tw_re = twiddles;
+	const float* tw_im = twiddles + size;
+
+	for (size_t k = 0; k < size; k += 4 * Float4::Width)
+	{
+		Float4 r0 = Float4::Load(re + k), r1 = Float4::Load(re + k + 4), r2 = Float4::Load(re + k + 8), r3 = Float4::Load(re + k + 12);
+		Float4 i0 = Float4::Load(im + k), i1 = Float4::Load(im + k + 4), i2 = Float4::Load(im + k + 8), i3 = Float4::Load(im + k + 12);
+		Transpose(r0, r1, r2, r3);
+		Transpose(i0, i1, i2, i3);
+
+		// Radix-4 butterfly with q = 1, all twiddles are 1.
+		Float4 pr = r0 + r1, pi = i0 + i1, mr = r0 - r1, mi = i0 - i1;
+		Float4 sr = r2 + r3, si = i2 + i3, dr = r2 - r3, di = i2 - i3;
+		r0 = pr + sr; i0 = pi + si;
+		r2 = pr - sr; i2 = pi - si;
+		r1 = mr - di; i1 = mi + dr; // (z0 - z1) + i(z2 - z3)
+		r3 = mr + di; i3 = mi - dr; // (z0 - z1) - i(z2 - z3)
+
+		Transpose(r0, r1, r2, r3);
+		Transpose(i0, i1, i2, i3);
+		r0.Store(re + k); r1.Store(re + k + 4); r2.Store(re + k + 8); r3.Store(re + k + 12);
+		i0.Store(im + k); i1.Store(im + k + 4); i2.Store(im + k + 8); i3.Store(im + k + 12);
+	}
+
+	size_t q = Float4::Width;
+
+	for (; 4 * q <= size; q *= 4)
+	{
+		for (size_t k = 0; k < size; k += 4 * q)
+		{
+			for (size_t j = 0; j < q; j += Float4::Width)
+			{
+				float* pr = re + k + j;
+				float* pi = im + k + j;
+				Float4 r0 = Float4::Load(pr), r1 = Float4::Load(pr + q), r2 = Float4::Load(pr + 2 * q), r3 = Float4::Load(pr + 3 * q);
+				Float4 i0 = Float4::Load(pi), i1 = Float4::Load(pi + q), i2 = Float4::Load(pi + 2 * q), i3 = Float4::Load(pi + 3 * q);
+
+				// Conjugated twiddles of the forward transform.
+				Float4 w1r = Float4::Load(tw_re + 2 * q + j), w1i = Float4::Load(tw_im + 2 * q + j);
+				Float4 w2r = Float4::Load(tw_re + q + j), w2i = Float4::Load(tw_im + q + j);
+				Float4 w3r = w1r, w3i = w1i;
+				MulComplex(w3r, w3i, w2r, w2i);
+				MulComplexConj(r1, i1, w2r, w2i);
+				MulComplexConj(r2, i2, w1r, w1i);
+				MulComplexConj(r3, i3, w3r, w3i);
+
+				Float4 ar = r0 + r1, ai = i0 + i1, br = r0 - r1, bi = i0 - i1;
+				Float4 sr = r2 + r3, si = i2 + i3, dr = r2 - r3, di = i2 - i3;
+				r0 = ar + sr; i0 = ai + si;
+				r2 = ar - sr; i2 = ai - si;
+				r1 = br - di; i1 = bi + dr;
+				r3 = br + di; i3 = bi - dr;
+
+				r0.Store(pr); r1.Store(pr + q); r2.Store(pr + 2 * q); r3.Store(pr + 3 * q);
+				i0.Store(pi); i1.Store(pi + q); i2.Store(pi + 2 * q); i3.Store(pi + 3 * q);
+			}
+		}
+	}
+
+	if (2 * q == size)
+	{
+		// Radix-2 stage with h = size/2.
+		for (size_t j = 0; j < size / 2; j += Float4::Width)
+		{
+			Float4 ar = Float4::Load(re + j), ai = Float4::Load(im + j);
+			Float4 br = Float4::Load(re + j + size / 2), bi = Float4::Load(im + j + size / 2);
+			MulComplexConj(br, bi, Float4::Load(tw_re + size / 2 + j), Float4::Load(tw_im + size / 2 + j));
+			(ar + br).Store(re + j); (ai + bi).Store(im + j);
+			(ar - br).Store(re + j + size / 2); (ai - bi).Store(im + j + size / 2);
+		}
+	}
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+//
+// Shaped noise: white noise filtered to follow the absolute threshold of hearing (Terhardt's approximation), so most of
+// the energy goes where ears are least sensitive, and the least of it goes to 2-5 kHz. The filter is a long linear
+// phase FIR (a quarter of the FFT size), so it's applied as overlap-save convolution in the frequency domain. The filter
+// is real, so 2 consecutive blocks of real noise are packed into one complex FFT as its real and imaginary parts.
+//
+
+struct ShapedNoise
+{
+	uint32_t fft_size;
+	uint32_t taps;
+	uint32_t frames_left; // Frames left in the current pair of blocks.
+	float* twiddles;      // 2 arrays of the FFT size.
+	float* spectrum;      // 2 arrays of the FFT size: the filter spectrum in bit-reversed order, scaled by 1/size.
+	float* work;          // 2 arrays of the FFT size: the current pair of blocks.
+};
+
+// About 85 ms at any sample rate, so the frequency resolution is the same.
+inline uint32_t GetShapedNoiseFftSize(uint32_t sample_rate)
+{
+	int32_t bits = 12 + int32_t(round(log2(sample_rate / 48000.0)));
+	return 1U << std::clamp(bits, 10, 14);
+}
+
+// Memory for the FFT size, in floats.
+constexpr size_t GetShapedNoiseMemorySize(uint32_t fft_size)
+{
+	return 6 * size_t(fft_size);
+}
+
+inline void InitShapedNoise(ShapedNoise& shaped, float* memory, uint32_t sample_rate)
+{
+	const size_t size = GetShapedNoiseFftSize(sample_rate);
+	const size_t taps = size / 4 + 1;
+	shaped.fft_size = uint32_t(size);
+	shaped.taps = uint32_t(taps);
+	shaped.frames_left = 0;
+	shaped.twiddles = memory;
+	shaped.spectrum = memory + 2 * size;
+	shaped.work = memory + 4 * size;
+
+	InitFftTwiddles(shaped.twiddles, size);
+	float* re = shaped.work;
+	float* im = shaped.work + size;
+
+	// The threshold in dB, limited to 80 dB of range, is the gain in dB. The threshold rises steeply above 15 kHz,
+	// the gain is cut at 20 kHz, so higher sample rates don't fill the output with ultrasound.
+	const double RANGE = 80.0;
+	auto threshold = [](double f) { f = std::max(f, 20.0) / 1000; return 3.64 * pow(f, -0.8) - 6.5 * exp(-0.6 * (f - 3.3) * (f - 3.3)) + 0.001 * f * f * f * f; };
+	double minimum = threshold(3300.0);
+
+	for (size_t k = 0; k < size; k++)
+	{
+		double f = double(std::min(k, size - k)) * sample_rate / size;
+		double gain = f < 20000.0 ? std::min(threshold(f) - minimum, RANGE) - RANGE : -RANGE;
+
+		// Zero phase response. The inverse transform takes bit-reversed order.
+		size_t index = 0;
+		for (size_t bit = 1, rev = size / 2; bit < size; bit *= 2, rev /= 2) { if (k & bit) { index |= rev; } }
+		re[index] = float(pow(10.0, gain / 20));
+		im[index] = 0.0f;
+	}
+
+	FftInverse(re, im, size, shaped.twiddles);
+
+	// The zero phase impulse response is centered on the first tap and windowed by the Hann window. The output is
+	// scaled to RMS of 0.25 (white noise in [-1, 1] has RMS of 1/sqrt(3)), so peaks are about the amplitude.
+	float* kernel = shaped.spectrum;
+	double energy = 0.0;
+
+	for (size_t i = 0; i < size; i++)
+	{
+		if (i < taps)
+		{
+			double window = 0.5 - 0.5 * cos(2 * M_PI * (i + 1) / (taps + 1));
+			kernel[i] = float(re[(i + size - taps / 2) % size] * window);
+			energy += double(kernel[i]) * kernel[i];
+		}
+		else
+		{
+			kernel[i] = 0.0f;
+		}
+	}
+
+	float scale = float(0.25 * sqrt(3.0) / sqrt(energy) / size);
+
+	for (size_t i = 0; i < size; i++)
+	{
+		re[i] = kernel[i] * scale;
+		im[i] = 0.0f;
+	}
+
+	FftForward(re, im, size, shaped.twiddles);
+	memcpy(shaped.spectrum, re, size * sizeof(float));
+	memcpy(shaped.spectrum + size, im, size * sizeof(float));
+}
+
+// The counter is the index of the first frame of the next pair of blocks.
+inline void GenerateShapedNoise(float* out, size_t count, uint32_t& counter, uint32_t seed, ShapedNoise& shaped, float amplitude,
+	UniformFunc generate_uniform = GenerateUniform<>)
+{
+	const size_t size = shaped.fft_size;
+	const size_t overlap = shaped.taps - 1;
+	const size_t block = size - overlap;
+	float* re = shaped.work;
+	float* im = shaped.work + size;
+
+	while (count)
+	{
+		if (!shaped.frames_left)
+		{
+			// Each block starts with the last input samples of the previous one. Noise is a hash of its index,
+			// so they are generated again instead of being kept.
+			generate_uniform(re, size, counter - uint32_t(overlap), seed, amplitude);
+			generate_uniform(im, size, counter + uint32_t(block - overlap), seed, amplitude);
+			FftForward(re, im, size, shaped.twiddles);
+
+			const float* filter_re = shaped.spectrum;
+			const float* filter_im = shaped.spectrum + size;
+
+			for (size_t i = 0; i < size; i += Float4::Width)
+			{
+				Float4 xr = Float4::Load(re + i), xi = Float4::Load(im + i);
+				Float4 hr = Float4::Load(filter_re + i), hi = Float4::Load(filter_im + i);
+				(xr * hr - xi * hi).Store(re + i);
+				(xr * hi + xi * hr).Store(im + i);
+			}
+
+			FftInverse(re, im, size, shaped.twiddles);
+			counter += uint32_t(2 * block);
+			shaped.frames_left = uint32_t(2 * block);
+		}
+
+		// Only the last samples of each block are valid.
+		size_t position = 2 * block - shaped.frames_left;
+		const float* source = position < block ? re + overlap + position : im + overlap + position - block;
+		size_t run = std::min(count, position < block ? block - position : 2 * block - position);
+		memcpy(out, source, run * sizeof(float));
+
+		out += run;
+		count -= run;
+		shaped.frames_left -= uint32_t(run);
+	}
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+//
+// Fade envelope. All supported curves satisfy gain[n+1] = p * gain[n] + q * gain[n-1] + c for a constant step of the
+// fade position, so the envelope costs a couple of multiplications per sample instead of evaluating the curve.
+// The caller initializes it from the curve at the first two frames of each block, so rounding errors don't add up.
+//
+
+struct FadeEnvelope
+{
+	double gain;
+	double prev_gain;
+	double p, q, c;
+
+	// Gain of the current frame. Moves to the next frame.
+	FORCEINLINE float Next()
+	{
+		float result = float(gain);
+		double next_gain = p * gain + q * prev_gain + c;
+		prev_gain = gain;
+		gain = next_gain;
+		return result;
+	}
+
+	// Gains of the next 4 frames.
+	FORCEINLINE Float4 Next4()
+	{
+		float g0 = Next(), g1 = Next(), g2 = Next(), g3 = Next();
+		return Float4::Set(g0, g1, g2, g3);
+	}
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+//
+// Block chains. A source kernel fills a block with mono samples. The rest of the chain runs as one loop over the
+// block, 4 frames per iteration, without intermediate buffers. The input stage loads the samples, the envelope and the
+// gain scale them, and the channel map writes them to all channels of the frames in the sample format of the writer.
+// Stages are template parameters, so each chain is compiled into its own loop, and any source can use all of them.
+// Sources are not fused, as most of them are recurrences or kernels that are selected at runtime.
+//
+
+// Parameters of a chain that are known only at runtime. The envelope starts at the first frame of the block, it's used
+// by chains with a fade.
+struct BlockParams
+{
+	FadeEnvelope envelope;
+	float gain;
+	size_t channels;
+	size_t frame_size;
+};
+
+typedef void (*BlockFunc)(uint8_t* out, const void* samples, size_t count, const BlockParams& params);
+
+// Input stages load 4 samples of the block as floats.
+
+struct FloatInput
+{
+	typedef float Sample;
+	static FORCEINLINE Float4 Load(const float* p) { return Float4::Load(p); }
+};
+
+// Q30 samples of fixed-point sources. The gain of the chain includes the 2^-30 scale.
+struct Q30Input
+{
+	typedef int32_t Sample;
+	static FORCEINLINE Float4 Load(const int32_t* p) { return ToFloat(Int4::Load(p)); }
+};
+
+// Writers store 4 samples in the sample format.
+
+struct Float32Writer
+{
+	typedef float Sample;
+	static FORCEINLINE void Store(float* p, Float4 x) { x.Store(p); }
+	static FORCEINLINE void Stream(float* p, Float4 x) { x.Stream(p); }
+};
+
+// Samples are scaled by 2^15 and saturated, as the audio engine converts them back.
+struct Int16Writer
+{
+	typedef int16_t Sample;
+	static FORCEINLINE void Store(int16_t* p, Float4 x) { StoreInt16(p, ToInt(x * Float4::Set(32768.0f))); }
+};
+
+// Channel maps write 4 frames, or fewer at the end of a block. The generic map writes frames of any size sample by
+// sample. Packed maps are for frames without padding, they write whole vectors. Streaming packed maps write them with
+// streaming stores (see ProcessBlockStreaming()), except for the last frames.
+
+template <typename Writer>
+struct GenericMap
+{
+	typedef typename Writer::Sample Sample;
+	static constexpr bool IsCopy = false;
+
+	static FORCEINLINE void Write(uint8_t* out, Float4 x, size_t frames, const BlockParams& params)
+	{
+		alignas(16) Sample samples[Float4::Width];
+		Writer::Store(samples, x);
+
+		for (size_t i = 0; i < frames; i++)
+		{
+			for (size_t j = 0; j < params.channels; j++)
+			{
+				reinterpret_cast<Sample*>(out)[j] = samples[i];
+			}
+
+			out += params.frame_size;
+		}
+	}
+
+	static FORCEINLINE void Write(uint8_t* out, Float4 x, const BlockParams& params)
+	{
+		Write(out, x, Float4::Width, params);
+	}
+};
+
+template <size_t Channels, typename Writer, bool Streaming = false>
+struct PackedMap
+{
+	typedef typename Writer::Sample Sample;
+	static constexpr bool IsCopy = (Channels == 1 && !Streaming && std::is_same_v<Writer, Float32Writer>);
+
+	static FORCEINLINE void Store(Sample* p, Float4 x)
+	{
+		if constexpr (Streaming) { Writer::Stream(p, x); } else { Writer::Store(p, x); }
+	}
+
+	static FORCEINLINE void Write(uint8_t* out, Float4 x, const BlockParams&)
+	{
+		Sample* p = reinterpret_cast<Sample*>(out);
+
+		if constexpr (Channels == 1)
+		{
+			Store(p, x);
+		}
+		else
+		{
+			// [s0 s0 s1 s1] [s2 s2 s3 s3].
+			Float4 low = ZipLow(x, x), high = ZipHigh(x, x);
+
+			if constexpr (Channels == 2)
+			{
+				Store(p, low);
+				Store(p + 4, high);
+			}
+			else if constexpr (Channels == 6)
+			{
+				// [s0 s0 s0 s0] [s0 s0 s1 s1] [s1 s1 s1 s1] [s2 s2 s2 s2] [s2 s2 s3 s3] [s3 s3 s3 s3].
+				Store(p, ZipLow(low, low));
+				Store(p + 4, low);
+				Store(p + 8, ZipHigh(low, low));
+				Store(p + 12, ZipLow(high, high));
+				Store(p + 16, high);
+				Store(p + 20, ZipHigh(high, high));
+			}
+			else
+			{
+				static_assert(Channels % Float4::Width == 0);
+				Float4 s0 = ZipLow(low, low), s1 = ZipHigh(low, low), s2 = ZipLow(high, high), s3 = ZipHigh(high, high);
+
+				for (size_t j = 0; j < Channels; j += Float4::Width)
+				{
+					Store(p + j, s0);
+					Store(p + Channels + j, s1);
+					Store(p + Channels * 2 + j, s2);
+					Store(p + Channels * 3 + j, s3);
+				}
+			}
+		}
+	}
+
+	static FORCEINLINE void Write(uint8_t* out, Float4 x, size_t frames, const BlockParams& params)
+	{
+		GenericMap<Writer>::Write(out, x, frames, params);
+	}
+};
+
+template <typename Input, bool Fade, bool Gain, typename Map>
+inline void ProcessBlock(uint8_t* out, const void* samples, size_t count, const BlockParams& block_params)
+{
+	typedef typename Input::Sample Sample;
+	const Sample* in = static_cast<const Sample*>(samples);
+
+	if constexpr (!Fade && !Gain && Map::IsCopy && std::is_same_v<Input, FloatInput>)
+	{
+		// Nothing to do but copy the samples.
+		memcpy(out, in, count * sizeof(Sample));
+		return;
+	}
+
+	// A local copy stays in registers, stores to the output can't change it.
+	BlockParams params = block_params;
+	const Float4 gain = Float4::Set(params.gain);
+
+	auto process = [&](Float4 x)
+	{
+		if constexpr (Fade) { x *= params.envelope.Next4(); }
+		if constexpr (Gain) { x *= gain; }
+		return x;
+	};
+
+	size_t i = 0;
+
+	for (; i + Float4::Width <= count; i += Float4::Width)
+	{
+		Map::Write(out + i * params.frame_size, process(Input::Load(in + i)), params);
+	}
+
+	if (i < count)
+	{
+		// The last frames are loaded from a padded copy, so nothing after the block is read.
+		alignas(16) Sample tail[Float4::Width] = {};
+		memcpy(tail, in + i, (count - i) * sizeof(Sample));
+		Map::Write(out + i * params.frame_size, process(Input::Load(tail)), count - i, params);
+	}
+}
+
+// Same for packed float frames, written with streaming stores. They need aligned vectors, and 4 packed float frames are
+// a whole number of vectors, so the first frames are written with regular stores until the output is aligned.
+template <typename Input, bool Fade, bool Gain, size_t Channels>
+inline void ProcessBlockStreaming(uint8_t* out, const void* samples, size_t count, const BlockParams& params)
+{
+	const typename Input::Sample* in = static_cast<const typename Input::Sample*>(samples);
+	size_t head = 0;
+
+	while (head < count && head < Float4::Width && reinterpret_cast<uintptr_t>(out + head * params.frame_size) % 16)
+	{
+		head++;
+	}
+
+	if (head == Float4::Width)
+	{
+		// Frames are never aligned.
+		ProcessBlock<Input, Fade, Gain, PackedMap<Channels, Float32Writer>>(out, in, count, params);
+		return;
+	}
+
+	BlockParams rest = params;
+
+	if (head)
+	{
+		ProcessBlock<Input, Fade, Gain, PackedMap<Channels, Float32Writer>>(out, in, head, params);
+		if constexpr (Fade) { for (size_t i = 0; i < head; i++) { rest.envelope.Next(); } }
+	}
+
+	ProcessBlock<Input, Fade, Gain, PackedMap<Channels, Float32Writer, true>>(out + head * params.frame_size, in + head, count - head, rest);
+}
+
+//
+// Chains of a session for its output format. Steady chains write samples of float sources as is, fade chains apply
+// the envelope. Fixed chains convert Q30 samples with the gain, the fixed-point fade is applied in Q30 before.
+// Use SelectBlockChains() to get them once the format is known.
+//
+
+struct BlockChains
+{
+	BlockFunc steady;
+	BlockFunc fade;
+	BlockFunc fixed;
+	bool is_packed;
+};
+
+template <typename Map>
+inline BlockChains MakeBlockChains(bool is_packed)
+{
+	return {
+		ProcessBlock<FloatInput, false, false, Map>,
+		ProcessBlock<FloatInput, true, false, Map>,
+		ProcessBlock<Q30Input, false, true, Map>,
+		is_packed,
+	};
+}
+
+inline BlockChains SelectBlockChains(size_t channels, size_t frame_size, bool is_int16)
+{
+	if (is_int16)
+	{
+		return (channels == 1 && frame_size == sizeof(int16_t)) ? MakeBlockChains<PackedMap<1, Int16Writer>>(true)
+			: MakeBlockChains<GenericMap<Int16Writer>>(false);
+	}
+
+	if (frame_size == channels * sizeof(float))
+	{
+		switch (channels)
+		{
+			case 1: return MakeBlockChains<PackedMap<1, Float32Writer>>(true);
+			case 2: return MakeBlockChains<PackedMap<2, Float32Writer>>(true);
+			case 6: return MakeBlockChains<PackedMap<6, Float32Writer>>(true);
+			case 8: return MakeBlockChains<PackedMap<8, Float32Writer>>(true);
+		}
+	}
+
+	return MakeBlockChains<GenericMap<Float32Writer>>(false);
+}
+
+//
+// Chains with streaming stores for large buffers. The audio engine reads them much later, and they would only evict
+// data of other applications from the cache. Available for packed float frames on targets with streaming stores,
+// other formats get null chains.
+//
+
+template <size_t Channels>
+inline BlockChains MakeStreamingBlockChains()
+{
+	return {
+		ProcessBlockStreaming<FloatInput, false, false, Channels>,
+		ProcessBlockStreaming<FloatInput, true, false, Channels>,
+		ProcessBlockStreaming<Q30Input, false, true, Channels>,
+		true,
+	};
+}
+
+inline BlockChains SelectStreamingBlockChains(size_t channels, size_t frame_size, bool is_int16)
+{
+#if IS_SIMD_STREAMING
+	if (!is_int16 && frame_size == channels * sizeof(float))
+	{
+		switch (channels)
+		{
+			case 1: return MakeStreamingBlockChains<1>();
+			case 2: return MakeStreamingBlockChains<2>();
+			case 6: return MakeStreamingBlockChains<6>();
+			case 8: return MakeStreamingBlockChains<8>();
+		}
+	}
+#else
+	UNUSED(channels);
+	UNUSED(frame_size);
+	UNUSED(is_int16);
+#endif
+
+	return {};
+}
+
+// Copy with streaming stores. Sizes are multiples of 4 bytes, as samples are.
+inline void CopyStreaming(uint8_t* out, const uint8_t* in, size_t size)
+{
+	size_t head = std::min(size, (16 - reinterpret_cast<uintptr_t>(out) % 16) % 16);
+	memcpy(out, in, head);
+
+	size_t i = head;
+
+	for (; i + 16 <= size; i += 16)
+	{
+		Float4::Load(reinterpret_cast<const float*>(in + i)).Stream(reinterpret_cast<float*>(out + i));
+	}
+
+	memcpy(out + i, in + i, size - i);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+//
+// Fixed-point kernels for targets without SIMD, x86-32 is built for x87 where float math is slow. Samples are Q30
+// integers (1.0 is 2^30, so results up to 2.0 don't overflow), and the fixed block chain turns them into floats once,
+// together with the amplitude. Q30 multiplication is a 32x32->64 bit multiplication, which is a single instruction
+// on x86.
+//
+
+const int32_t Q30_ONE = 1 << 30;
+
+FORCEINLINE int32_t MulQ30(int32_t a, int32_t b)
+{
+	return int32_t((int64_t(a) * b) >> 30);
+}
+
+// Multiplies samples by the gain that changes linearly by the step each frame.
+inline void ApplyGainRampQ30(int32_t* samples, size_t count, int32_t gain, int32_t step)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		samples[i] = MulQ30(samples[i], gain);
+		gain += step;
+	}
+}
+
+// Sine from the table with linear interpolation: out[i] = sin(phase + i * increment).
+inline void GenerateSineQ30(int32_t* out, size_t count, uint32_t phase, uint32_t increment)
+{
+	const uint32_t FRACTION_BITS = 32 - SINE_TABLE_BITS;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		// Adjacent entries differ by less than 2^23, so the difference / 2^8 times a 15-bit fraction fits 32 bits.
+		uint32_t index = phase >> FRACTION_BITS;
+		int32_t fraction = int32_t((phase >> (FRACTION_BITS - 15)) & 0x7FFF);
+		int32_t a = g_sine_table_q30[index];
+		int32_t b = g_sine_table_q30[index + 1];
+		out[i] = a + ((((b - a) >> 8) * fraction) >> 7);
+		phase += increment;
+	}
+}
+
+// Uniform white noise in [-1, 1).
+inline void GenerateUniformQ30(int32_t* out, size_t count, uint32_t counter, uint32_t seed)
+{
+	GenerateRandom(out, count, counter, seed);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		out[i] >>= 1;
+	}
+}
+
+// Same as FilterBrownNoise(). The state is Q27, so it has room for the bound at high sample rates.
+inline void FilterBrownNoiseQ30(int32_t* samples, size_t count, int32_t& state, const BrownNoiseFilter& filter)
+{
+	const int32_t ONE = 1 << 27;
+	const int32_t LEAK = int32_t(filter.leak * Q30_ONE + 0.5);
+	const int32_t GAIN = int32_t(filter.gain * ONE + 0.5); // Q30 white times Q30 GAIN / 2^30 is Q27.
+	int32_t value = state;
+
+	// Only the integrator is serial.
+	for (size_t i = 0; i < count; i++)
+	{
+		value = MulQ30(value + MulQ30(samples[i], GAIN), LEAK);
+		samples[i] = value;
+	}
+
+	state = value;
+
+	// Normalize values out of the -1..1 range using "mirroring": 1 - ||x| - 3| - 2| with the sign of x.
+	for (size_t i = 0; i < count; i++)
+	{
+		int32_t x = samples[i];
+		int32_t sign = x >> 31;
+		int32_t d = ((x ^ sign) - sign) - 3 * ONE;
+		d = ((d ^ (d >> 31)) - (d >> 31)) - 2 * ONE;
+		int32_t y = ONE - ((d ^ (d >> 31)) - (d >> 31));
+		samples[i] = ((y ^ sign) - sign) * (Q30_ONE / ONE);
+	}
+}
+
+// Same as GeneratePinkNoiseVoss() and has the same state.
+inline void GeneratePinkNoiseVossQ30(int32_t* out, size_t count, uint32_t counter, uint32_t seed, int32_t* state, uint32_t row_count)
+{
+	// Rows in [-2^26, 2^26) to Q30 with the gain of GeneratePinkNoiseVoss().
+	const int32_t GAIN = int32_t(0.193 / 2.3094 * 16 * Q30_ONE + 0.5);
+
+	int32_t* rows = state;
+	int32_t sum = state[PINK_NOISE_MAX_ROWS];
+
+	GenerateRandom(out, count, counter, seed);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		unsigned long row;
+		if (_BitScanForward(&row, counter + uint32_t(i)) && row < row_count)
+		{
+			int32_t value = int32_t(uint32_t(out[i]) << 16) >> 5;
+			sum += value - rows[row];
+			rows[row] = value;
+		}
+
+		// The white value has the same weight as a row has.
+		out[i] = MulQ30(sum + ((out[i] & int32_t(0xFFFF0000)) >> 5), GAIN);
+	}
+
+	state[PINK_NOISE_MAX_ROWS] = sum;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+//
+// Multichannel noise. Each lane of a vector is a channel with its own random sequence and filter state, so the channels
+// of a vector cost about as much as one. Lane blocks are frames of one vector, FanOutLanes() writes them to the channels.
+// Channels beyond NOISE_LANE_CHANNELS repeat the first ones. The kernels are generic, and sessions bind the widest ones
+// for the CPU (see NoiseLaneKernels). With AVX2, 5.1 and 7.1 take a single pass, and packed frames are written with
+// whole vector stores. Filters are bound by the latency of their recurrences, which doesn't depend on the width, so 7.1
+// pink noise costs about twice as much as mono pink noise written to all channels (7 vs 3.5 ns per frame, measured by
+// Benchmarks/DecorrelatedNoiseBenchmark.cpp). With 4 lanes, it takes two passes and about 4 times as much.
+//
+
+const size_t NOISE_LANE_CHANNELS = 8;
+
+// State of all channels, indexed by channel. Zeroed state is valid.
+struct NoiseLanesState
+{
+	float poles[8][NOISE_LANE_CHANNELS]; // Pink Noise (poles and the delayed white term) or Brown Noise (the first row).
+	int32_t rows[PINK_NOISE_MAX_ROWS + 1][NOISE_LANE_CHANNELS]; // Pink Noise (Voss-McCartney): rows and their sum.
+};
+
+// Seeds of the lanes starting from the first channel. Channel 0 has the session seed, so it matches the mono noise.
+template <typename I = Int4>
+inline I NoiseLaneSeeds(uint32_t seed, size_t first_channel)
+{
+	return I::Set(seed + uint32_t(first_channel) * 0x9E3779B9) + I::Iota() * I::Set(0x9E3779B9);
+}
+
+template <typename F = Float4, typename I = Int4>
+inline void GenerateUniformLanes(float* out, size_t count, uint32_t counter, uint32_t seed, size_t first_channel, float amplitude)
+{
+	I x = NoiseLaneSeeds<I>(seed, first_channel) + I::Set(counter);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		(ToFloat(HashCounter(x)) * F::Set(amplitude / 2147483648.0f)).Store(out + i * F::Width);
+		x += I::Set(1);
+	}
+}
+
+// Same as FilterBrownNoise() in single precision. The leak forgets rounding errors quickly, so the output differs from
+// the double version by less than 1e-6 of the amplitude (checked by Tests/GeneratorPrecision.cpp).
+template <typename F = Float4>
+inline void FilterBrownNoiseLanes(float* samples, size_t count, NoiseLanesState& state, size_t first_channel, const BrownNoiseFilter& filter, float amplitude)
+{
+	const F leak = F::Set(float(filter.leak));
+	const F gain = F::Set(float(filter.leak * filter.gain));
+	F value = F::Load(state.poles[0] + first_channel);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		float* p = samples + i * F::Width;
+		value = value * leak + F::Load(p) * gain;
+
+		// Mirroring, see FilterBrownNoise().
+		F sign = value & F::Set(-0.0f);
+		F y = F::Set(1.0f) - Abs(Abs((value ^ sign) - F::Set(3.0f)) - F::Set(2.0f));
+		((y ^ sign) * F::Set(amplitude)).Store(p);
+	}
+
+	value.Store(state.poles[0] + first_channel);
+}
+
+template <typename F = Float4>
+inline void FilterPinkNoiseLanes(float* samples, size_t count, NoiseLanesState& state, size_t first_channel, const PinkNoiseFilter& filter, float amplitude)
+{
+	// Same as FilterPinkNoise(). The poles are spelled out, so their states stay in registers.
+	const F p0 = F::Set(float(filter.poles[0])), g0 = F::Set(float(filter.gains[0]));
+	const F p1 = F::Set(float(filter.poles[1])), g1 = F::Set(float(filter.gains[1]));
+	const F p2 = F::Set(float(filter.poles[2])), g2 = F::Set(float(filter.gains[2]));
+	const F p3 = F::Set(float(filter.poles[3])), g3 = F::Set(float(filter.gains[3]));
+	const F p4 = F::Set(float(filter.poles[4])), g4 = F::Set(float(filter.gains[4]));
+	const F p5 = F::Set(float(filter.poles[5])), g5 = F::Set(float(filter.gains[5]));
+	const F direct = F::Set(float(filter.direct));
+	const F delayed = F::Set(float(filter.delayed));
+	const F scale = F::Set(0.11f * amplitude); // (roughly) compensate for gain.
+
+	float (*poles)[NOISE_LANE_CHANNELS] = state.poles;
+	F s0 = F::Load(poles[0] + first_channel), s1 = F::Load(poles[1] + first_channel), s2 = F::Load(poles[2] + first_channel);
+	F s3 = F::Load(poles[3] + first_channel), s4 = F::Load(poles[4] + first_channel), s5 = F::Load(poles[5] + first_channel);
+	F s6 = F::Load(poles[6] + first_channel);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		float* p = samples + i * F::Width;
+		F white = F::Load(p);
+
+		s0 = s0 * p0 + white * g0;
+		s1 = s1 * p1 + white * g1;
+		s2 = s2 * p2 + white * g2;
+		s3 = s3 * p3 + white * g3;
+		s4 = s4 * p4 + white * g4;
+		s5 = s5 * p5 + white * g5;
+		F value = ((s0 + s1) + (s2 + s3)) + ((s4 + s5) + (s6 + white * direct));
+		s6 = white * delayed;
+
+		(value * scale).Store(p);
+	}
+
+	s0.Store(poles[0] + first_channel); s1.Store(poles[1] + first_channel); s2.Store(poles[2] + first_channel);
+	s3.Store(poles[3] + first_channel); s4.Store(poles[4] + first_channel); s5.Store(poles[5] + first_channel);
+	s6.Store(poles[6] + first_channel);
+}
+
+template <typename F = Float4, typename I = Int4>
+inline void GeneratePinkNoiseVossLanes(float* out, size_t count, uint32_t counter, uint32_t seed, size_t first_channel, NoiseLanesState& state, uint32_t row_count, float amplitude)
+{
+	// Same as GeneratePinkNoiseVoss().
+	const F scale = F::Set(amplitude * (0.193f / 2.3094f / (1 << 26)));
+	I x = NoiseLaneSeeds<I>(seed, first_channel) + I::Set(counter);
+	I sum = I::Load(state.rows[PINK_NOISE_MAX_ROWS] + first_channel);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		I random = HashCounter(x);
+		x += I::Set(1);
+
+		unsigned long row;
+		if (_BitScanForward(&row, counter + uint32_t(i)) && row < row_count)
+		{
+			// The low 16 bits are the new row value, as a signed 27-bit integer. Shifts are logical, so the arithmetic
+			// shift is done on the value biased by 2^31, and the bias is removed after.
+			I value = (((random << 16) ^ I::Set(0x80000000)) >> 5) - I::Set(0x80000000 >> 5);
+			sum += value - I::Load(state.rows[row] + first_channel);
+			value.Store(state.rows[row] + first_channel);
+		}
+
+		I white = random & I::Set(0xFFFF0000);
+		(ToFloat(sum) * scale + ToFloat(white) * (scale * F::Set(1.0f / 32))).Store(out + i * F::Width);
+	}
+
+	sum.Store(state.rows[PINK_NOISE_MAX_ROWS] + first_channel);
+}
+
+// Write lanes to channels starting from the first one of float frames, and to the channels that repeat them.
+// It's the lanes version of a block chain, the fade is applied while lanes are written.
+template <bool Fade, typename F = Float4>
+inline void FanOutLanes(uint8_t* out, const float* lanes, size_t count, size_t first_channel, const BlockParams& params)
+{
+	const size_t channels = params.channels, frame_size = params.frame_size;
+	size_t lanes_count = std::min(channels - first_channel, F::Width);
+	FadeEnvelope envelope = params.envelope;
+
+	auto load = [&](size_t i)
+	{
+		F x = F::Load(lanes + i * F::Width);
+		if constexpr (Fade) { x *= F::Set(envelope.Next()); }
+		return x;
+	};
+
+	if (channels <= NOISE_LANE_CHANNELS && lanes_count == F::Width)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			load(i).Store(reinterpret_cast<float*>(out + i * frame_size) + first_channel);
+		}
+	}
+	else if (lanes_count == channels && frame_size == channels * sizeof(float))
+	{
+		// Packed frames narrower than a vector. Each store spills into the next frames, which are written after it.
+		// The last frames are copied, so nothing after the block is written.
+		size_t i = 0;
+
+		for (; (count - i) * frame_size >= F::Width * sizeof(float); i++)
+		{
+			load(i).Store(reinterpret_cast<float*>(out + i * frame_size));
+		}
+
+		for (; i < count; i++)
+		{
+			alignas(32) float x[F::Width];
+			load(i).Store(x);
+			memcpy(out + i * frame_size, x, frame_size);
+		}
+	}
+	else if (channels <= NOISE_LANE_CHANNELS && lanes_count == 2)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			alignas(32) float x[F::Width];
+			load(i).Store(x);
+			float* frame = reinterpret_cast<float*>(out + i * frame_size) + first_channel;
+			frame[0] = x[0];
+			frame[1] = x[1];
+		}
+	}
+	else
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			alignas(32) float x[F::Width];
+			load(i).Store(x);
+			float* frame = reinterpret_cast<float*>(out + i * frame_size);
+
+			for (size_t j = 0; j < lanes_count; j++)
+			{
+				for (size_t c = first_channel + j; c < channels; c += NOISE_LANE_CHANNELS)
+				{
+					frame[c] = x[j];
+				}
+			}
+		}
+	}
+}
+
+// Lane kernels of one vector width. Channels are generated in passes of `width` channels.
+struct NoiseLaneKernels
+{
+	size_t width;
+	void (*generate_uniform)(float* out, size_t count, uint32_t counter, uint32_t seed, size_t first_channel, float amplitude);
+	void (*filter_brown)(float* samples, size_t count, NoiseLanesState& state, size_t first_channel, const BrownNoiseFilter& filter, float amplitude);
+	void (*filter_pink)(float* samples, size_t count, NoiseLanesState& state, size_t first_channel, const PinkNoiseFilter& filter, float amplitude);
+	void (*generate_pink_voss)(float* out, size_t count, uint32_t counter, uint32_t seed, size_t first_channel, NoiseLanesState& state, uint32_t row_count, float amplitude);
+	void (*fan_out)(uint8_t* out, const float* lanes, size_t count, size_t first_channel, const BlockParams& params);
+	void (*fan_out_fade)(uint8_t* out, const float* lanes, size_t count, size_t first_channel, const BlockParams& params);
+};
+
+template <typename F = Float4, typename I = Int4>
+inline NoiseLaneKernels MakeNoiseLaneKernels()
+{
+	static_assert(NOISE_LANE_CHANNELS % F::Width == 0);
+
+	return
+	{
+		F::Width, GenerateUniformLanes<F, I>, FilterBrownNoiseLanes<F>, FilterPinkNoiseLanes<F>, GeneratePinkNoiseVossLanes<F, I>,
+		FanOutLanes<false, F>, FanOutLanes<true, F>,
+	};
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+//
+// Kernels for instruction sets newer than the baseline of the target. Each session binds the best ones for the CPU once,
+// so generators call them through pointers. AVX2 versions are the generic kernels built for Float8 and Int8. The noise
+// hash multiplies 32-bit integers, which SSE2 doesn't have, so it gets a separate SSE4.1 version. It's written without
+// the vector types, so 32-bit builds for CPUs without SSE can use it too.
+//
+
+#if IS_X86
+
+inline void GenerateUniformSse41(float* out, size_t count, uint32_t counter, uint32_t seed, float amplitude)
+{
+	__m128i x = _mm_add_epi32(_mm_set1_epi32(int(counter + seed)), _mm_setr_epi32(0, 1, 2, 3));
+	const __m128i step = _mm_set1_epi32(4);
+	const __m128 scale = _mm_set1_ps(amplitude / 2147483648.0f);
+
+	for (size_t i = 0; i < count; i += 4)
+	{
+		// HashCounter().
+		__m128i h = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+		h = _mm_mullo_epi32(h, _mm_set1_epi32(0x7FEB352D));
+		h = _mm_xor_si128(h, _mm_srli_epi32(h, 15));
+		h = _mm_mullo_epi32(h, _mm_set1_epi32(int(0x846CA68B)));
+		h = _mm_xor_si128(h, _mm_srli_epi32(h, 16));
+		_mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(h), scale));
+		x = _mm_add_epi32(x, step);
+	}
+}
+
+#endif
+
+#if IS_SIMD_AVX2
+
+// Steady chains of float sources only copy samples to the channels, so they get AVX2 versions.
+template <size_t Channels>
+inline void FanOutPackedAvx2(uint8_t* out, const void* block, size_t count, const BlockParams& params)
+{
+	const float* samples = static_cast<const float*>(block);
+	float* p = reinterpret_cast<float*>(out);
+	size_t i = 0;
+
+	if constexpr (Channels == 2)
+	{
+		// 8 frames per iteration. Unpacking works within 128-bit halves, so the halves are swapped afterwards.
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256 x = _mm256_loadu_ps(samples + i);
+			__m256 low = _mm256_unpacklo_ps(x, x);
+			__m256 high = _mm256_unpackhi_ps(x, x);
+			_mm256_storeu_ps(p + i * 2, _mm256_permute2f128_ps(low, high, 0x20));
+			_mm256_storeu_ps(p + i * 2 + 8, _mm256_permute2f128_ps(low, high, 0x31));
+		}
+	}
+	else if constexpr (Channels == 6)
+	{
+		// 4 frames per iteration: [s0 x6, s1 x2] [s1 x4, s2 x4] [s2 x2, s3 x6].
+		for (; i + 4 <= count; i += 4)
+		{
+			__m256 s0 = _mm256_set1_ps(samples[i]), s1 = _mm256_set1_ps(samples[i + 1]);
+			__m256 s2 = _mm256_set1_ps(samples[i + 2]), s3 = _mm256_set1_ps(samples[i + 3]);
+			_mm256_storeu_ps(p + i * 6, _mm256_blend_ps(s0, s1, 0xC0));
+			_mm256_storeu_ps(p + i * 6 + 8, _mm256_blend_ps(s1, s2, 0xF0));
+			_mm256_storeu_ps(p + i * 6 + 16, _mm256_blend_ps(s2, s3, 0xFC));
+		}
+	}
+	else
+	{
+		static_assert(Channels == 8);
+
+		for (; i < count; i++)
+		{
+			_mm256_storeu_ps(p + i * 8, _mm256_set1_ps(samples[i]));
+		}
+	}
+
+	ProcessBlock<FloatInput, false, false, PackedMap<Channels, Float32Writer>>(out + i * params.frame_size, samples + i, count - i, params);
+}
+
+inline BlockChains SelectBlockChainsAvx2(size_t channels, size_t frame_size, bool is_int16)
+{
+	BlockChains chains = SelectBlockChains(channels, frame_size, is_int16);
+
+	if (!is_int16 && frame_size == channels * sizeof(float))
+	{
+		switch (channels)
+		{
+			case 2: chains.steady = FanOutPackedAvx2<2>; break;
+			case 6: chains.steady = FanOutPackedAvx2<6>; break;
+			case 8: chains.steady = FanOutPackedAvx2<8>; break;
+		}
+	}
+
+	return chains;
+}
+
+#endif
+
+struct GeneratorKernels
+{
+	const char* name;
+	SineFunc generate_sine;
+	UniformFunc generate_uniform;
+	BlockChains (*select_chains)(size_t channels, size_t frame_size, bool is_int16);
+	NoiseLaneKernels lanes;
+};
+
+// AVX-512 is not used: blocks are short, fan-out is bound by memory, and wide instructions lower the clock on many CPUs.
+inline GeneratorKernels SelectGeneratorKernels(const CpuFeatures& cpu)
+{
+#if IS_SIMD_AVX2
+	if (cpu.avx2)
+	{
+		return { "AVX2", GenerateSine<Float8, Int8>, GenerateUniform<Float8, Int8>, SelectBlockChainsAvx2, MakeNoiseLaneKernels<Float8, Int8>() };
+	}
+#endif
+
+#if IS_X86
+	if (cpu.sse41)
+	{
+		return { "SSE4.1", GenerateSine<>, GenerateUniformSse41, SelectBlockChains, MakeNoiseLaneKernels<>() };
+	}
+#endif
+
+	UNUSED(cpu);
+	return { IS_SIMD_SSE2 ? "SSE2" : IS_SIMD_NEON ? "NEON" : "Scalar", GenerateSine<>, GenerateUniform<>, SelectBlockChains, MakeNoiseLaneKernels<>() };
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
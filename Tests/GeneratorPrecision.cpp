@@ -0,0 +1,192 @@
+//
+// Precision checker for the single precision generators. Each one is run over a long stream next to its double
+// precision reference, and the largest difference is checked against the bound stated next to the generator.
+// It's a standalone console program, it's not a part of the main build. Returns 0 when all bounds hold.
+//
+
+#include "../SoundGenerators.hpp"
+#include <stdio.h>
+
+const uint32_t SAMPLE_RATE = 48000;
+const uint32_t BLOCK_FRAMES = 256; // Same as blocks of CSoundSession.
+const uint64_t STREAM_FRAMES = 100'000'000;
+const uint32_t SEED = 0x5EED1234;
+
+struct Result
+{
+	double max_error;
+	uint64_t max_frame;
+};
+
+// Keep the largest difference relative to the amplitude.
+static void Compare(Result& result, const float* test, const double* reference, size_t count, uint64_t first_frame, double amplitude)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		double error = fabs(test[i] - reference[i]) / amplitude;
+		if (error > result.max_error)
+		{
+			result.max_error = error;
+			result.max_frame = first_frame + i;
+		}
+	}
+}
+
+static bool Check(const char* name, const Result& result, double bound)
+{
+	bool is_ok = result.max_error < bound;
+	printf("%-40s max error %.3e at frame %llu, bound %.1e: %s\n", name, result.max_error,
+		(unsigned long long)result.max_frame, bound, is_ok ? "OK" : "FAILED");
+	return is_ok;
+}
+
+//
+// FilterPinkNoiseFloat() against FilterPinkNoise(). The double filter is fed with the same float white noise,
+// but its output is kept in double, so the rounding of the output is counted too.
+static Result TestPinkNoise(float amplitude)
+{
+	PinkNoiseFilter filter = MakePinkNoiseFilter(SAMPLE_RATE);
+	float float_state[9] = {};
+	double double_state[8] = {};
+	alignas(32) float white[BLOCK_FRAMES];
+	alignas(32) float test[BLOCK_FRAMES];
+	double reference[BLOCK_FRAMES];
+	Result result = {};
+
+	for (uint64_t frame = 0; frame < STREAM_FRAMES; frame += BLOCK_FRAMES)
+	{
+		GenerateUniform(white, BLOCK_FRAMES, uint32_t(frame), SEED, 1.0f);
+		memcpy(test, white, sizeof(white));
+		FilterPinkNoiseFloat(test, BLOCK_FRAMES, float_state, filter, amplitude);
+
+		// Same as FilterPinkNoise(), but without rounding the output to float.
+		const double* p = filter.poles;
+		const double* g = filter.gains;
+		for (size_t i = 0; i < BLOCK_FRAMES; i++)
+		{
+			double w = white[i];
+			double* s = double_state;
+			s[0] = p[0] * s[0] + w * g[0];
+			s[1] = p[1] * s[1] + w * g[1];
+			s[2] = p[2] * s[2] + w * g[2];
+			s[3] = p[3] * s[3] + w * g[3];
+			s[4] = p[4] * s[4] + w * g[4];
+			s[5] = p[5] * s[5] + w * g[5];
+			double value = s[0] + s[1] + s[2] + s[3] + s[4] + s[5] + s[6] + w * filter.direct;
+			s[6] = w * filter.delayed;
+			reference[i] = value * 0.11 * amplitude;
+		}
+
+		Compare(result, test, reference, BLOCK_FRAMES, frame, amplitude);
+	}
+
+	return result;
+}
+
+//
+// A sine kernel against sin() in double. The phase is the same 32-bit accumulator, so only the sine itself differs.
+static Result TestSine(SineFunc generate_sine, double frequency, float amplitude)
+{
+	uint32_t increment = SinePhaseIncrement(frequency, SAMPLE_RATE);
+	uint32_t phase = 0;
+	alignas(32) float test[BLOCK_FRAMES];
+	double reference[BLOCK_FRAMES];
+	Result result = {};
+
+	for (uint64_t frame = 0; frame < STREAM_FRAMES; frame += BLOCK_FRAMES)
+	{
+		generate_sine(test, BLOCK_FRAMES, phase, increment, amplitude);
+
+		for (size_t i = 0; i < BLOCK_FRAMES; i++)
+		{
+			uint32_t sample_phase = phase + uint32_t(i) * increment;
+			reference[i] = sin(int32_t(sample_phase) * (M_PI / 2147483648.0)) * amplitude;
+		}
+
+		Compare(result, test, reference, BLOCK_FRAMES, frame, amplitude);
+		phase += increment * BLOCK_FRAMES;
+	}
+
+	return result;
+}
+
+//
+// Lane 0 of FilterBrownNoiseLanes() against FilterBrownNoise(). Lane 0 has the same seed as the mono noise.
+static Result TestBrownNoise(const NoiseLaneKernels& kernels, float amplitude)
+{
+	BrownNoiseFilter filter = MakeBrownNoiseFilter(SAMPLE_RATE);
+	NoiseLanesState lanes_state = {};
+	double double_state = 0.0;
+	alignas(32) float lanes[BLOCK_FRAMES * NOISE_LANE_CHANNELS];
+	alignas(32) float mono[BLOCK_FRAMES];
+	alignas(32) float test[BLOCK_FRAMES];
+	double reference[BLOCK_FRAMES];
+	Result result = {};
+
+	for (uint64_t frame = 0; frame < STREAM_FRAMES; frame += BLOCK_FRAMES)
+	{
+		kernels.generate_uniform(lanes, BLOCK_FRAMES, uint32_t(frame), SEED, 0, 1.0f);
+		kernels.filter_brown(lanes, BLOCK_FRAMES, lanes_state, 0, filter, amplitude);
+
+		GenerateUniform(mono, BLOCK_FRAMES, uint32_t(frame), SEED, 1.0f);
+		FilterBrownNoise(mono, BLOCK_FRAMES, double_state, filter, amplitude);
+
+		for (size_t i = 0; i < BLOCK_FRAMES; i++)
+		{
+			test[i] = lanes[i * kernels.width];
+			reference[i] = mono[i];
+		}
+
+		Compare(result, test, reference, BLOCK_FRAMES, frame, amplitude);
+	}
+
+	return result;
+}
+
+int main()
+{
+	// Bounds stated in SoundGenerators.hpp.
+	const double PINK_NOISE_BOUND = 2e-6;
+	const double BROWN_NOISE_BOUND = 1e-6;
+	const double SINE_BOUND = 3e-7;
+
+	// Keep-alive amplitude (1%) and full scale. The bounds are relative, so both should pass.
+	const float AMPLITUDES[] = { 0.01f, 1.0f };
+	const double FREQUENCIES[] = { 1.0, 440.0, 18000.0 };
+
+	// The baseline kernels and the ones sessions select on this CPU.
+	GeneratorKernels kernels = SelectGeneratorKernels(DetectCpuFeatures());
+	struct { const char* name; SineFunc generate_sine; } sines[] = { { "Baseline", GenerateSine<> }, { kernels.name, kernels.generate_sine } };
+	size_t sines_count = (kernels.generate_sine == sines[0].generate_sine) ? 1 : 2;
+	struct { const char* name; NoiseLaneKernels lanes; } lanes[] = { { "Baseline", MakeNoiseLaneKernels<>() }, { kernels.name, kernels.lanes } };
+	size_t lanes_count = (kernels.lanes.width == lanes[0].lanes.width) ? 1 : 2;
+
+	bool is_ok = true;
+	char name[64];
+
+	printf("Frames per test: %llu.\n", (unsigned long long)STREAM_FRAMES);
+
+	for (float amplitude : AMPLITUDES)
+	{
+		sprintf(name, "Pink (float), amplitude %g", amplitude);
+		is_ok &= Check(name, TestPinkNoise(amplitude), PINK_NOISE_BOUND);
+
+		for (size_t i = 0; i < lanes_count; i++)
+		{
+			sprintf(name, "Brown (%s lanes), amplitude %g", lanes[i].name, amplitude);
+			is_ok &= Check(name, TestBrownNoise(lanes[i].lanes, amplitude), BROWN_NOISE_BOUND);
+		}
+
+		for (size_t i = 0; i < sines_count; i++)
+		{
+			for (double frequency : FREQUENCIES)
+			{
+				sprintf(name, "Sine (%s) %gHz, amplitude %g", sines[i].name, frequency, amplitude);
+				is_ok &= Check(name, TestSine(sines[i].generate_sine, frequency, amplitude), SINE_BOUND);
+			}
+		}
+	}
+
+	printf(is_ok ? "All bounds hold.\n" : "Some bounds are exceeded.\n");
+	return is_ok ? 0 : 1;
+}